@@ -45,8 +45,7 @@ void AudioEngine::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
 {
     currentSampleRate = sampleRate;
     playbackRatio = static_cast<double>(waveformSampleRate) / sampleRate;
-    interpolator.reset();
-    fractionalPosition = 0.0;
+    prepareResampler();
     
     DBG("AudioEngine::prepareToPlay - Device sample rate: " + juce::String(sampleRate) + 
         " Hz, Waveform sample rate: " + juce::String(waveformSampleRate) + 
@@ -88,25 +87,32 @@ void AudioEngine::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferTo
         return;
     }
     
-    // Use interpolator for sample rate conversion
+    // The resampler is being replaced (new waveform or device rate)
+    const juce::SpinLock::ScopedTryLockType lock(resamplerLock);
+    if (!lock.isLocked() || resampler == nullptr)
+    {
+        bufferToFill.clearActiveBufferRegion();
+        return;
+    }
+    
     const float* inputData = currentWaveform.getReadPointer(0);
     float* outputData = outputBuffer->getWritePointer(0, startSample);
     
     // Calculate how many input samples we need
     int inputSamplesAvailable = static_cast<int>(waveformLength - pos);
     
-    // Process with interpolation
-    int samplesUsed = interpolator.process(
-        playbackRatio,
-        inputData + pos,
-        outputData,
-        numOutputSamples,
-        inputSamplesAvailable,
-        0  // No wrap
-    );
+    // Streaming polyphase conversion; it reads only what this block needs
+    const auto [samplesUsed, samplesProduced] = resampler->process(inputData + pos, inputSamplesAvailable,
+                                                                   outputData, numOutputSamples);
+    
+    // The end of the waveform: the last few lookahead samples are dropped
+    if (samplesProduced < numOutputSamples)
+        juce::FloatVectorOperations::clear(outputData + samplesProduced, numOutputSamples - samplesProduced);
     
     // Update position
     int64_t newPos = pos + samplesUsed;
+    if (samplesProduced < numOutputSamples)
+        newPos = waveformLength;
     currentPosition.store(newPos);
     
     // Copy to other channels (if stereo output)
@@ -156,13 +162,32 @@ void AudioEngine::loadWaveform(const juce::AudioBuffer<float>& buffer, int sampl
     else
         playbackRatio = 1.0;
     
-    interpolator.reset();
-    fractionalPosition = 0.0;
+    prepareResampler();
     
     DBG("Loaded waveform: " + juce::String(buffer.getNumSamples()) + " samples at " + 
         juce::String(sampleRate) + " Hz, playback ratio: " + juce::String(playbackRatio));
 }
 
+void AudioEngine::updateWaveformRegion(int startSample, const float* samples, int numSamples)
+{
+    const int length = std::min(numSamples, currentWaveform.getNumSamples() - startSample);
+    if (startSample < 0 || length <= 0)
+        return;
+    
+    // The callback skips a block rather than read a half-written region
+    const juce::SpinLock::ScopedLockType lock(resamplerLock);
+    currentWaveform.copyFrom(0, startSample, samples, length);
+}
+
+void AudioEngine::prepareResampler()
+{
+    // Built outside the lock: the filter table may be computed on first use
+    auto newResampler = std::make_unique<Resampler>(waveformSampleRate, juce::roundToInt(currentSampleRate));
+    
+    const juce::SpinLock::ScopedLockType lock(resamplerLock);
+    resampler = std::move(newResampler);
+}
+
 void AudioEngine::play()
 {
     if (currentWaveform.getNumSamples() == 0)
@@ -184,8 +209,10 @@ void AudioEngine::stop()
 {
     playing = false;
     currentPosition.store(0);
-    interpolator.reset();
-    fractionalPosition = 0.0;
+    
+    const juce::SpinLock::ScopedLockType lock(resamplerLock);
+    if (resampler != nullptr)
+        resampler->reset();
 }
 
 void AudioEngine::seek(double timeSeconds)
@@ -193,8 +220,10 @@ void AudioEngine::seek(double timeSeconds)
     int64_t newPos = static_cast<int64_t>(timeSeconds * waveformSampleRate);
     newPos = juce::jlimit<int64_t>(0, currentWaveform.getNumSamples(), newPos);
     currentPosition.store(newPos);
-    interpolator.reset();
-    fractionalPosition = 0.0;
+    
+    const juce::SpinLock::ScopedLockType lock(resamplerLock);
+    if (resampler != nullptr)
+        resampler->reset();
 }
 
 double AudioEngine::getPosition() const
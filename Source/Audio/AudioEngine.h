@@ -2,6 +2,7 @@
 
 #include "../JuceHeader.h"
 #include "../Models/Project.h"
+#include "../Utils/Resampler.h"
 #include <functional>
 
 /**
@@ -26,6 +27,12 @@ public:
     void setProject(Project* proj) { project = proj; }
     void loadWaveform(const juce::AudioBuffer<float>& buffer, int sampleRate);
     
+    /**
+     * Overwrite part of the loaded waveform without stopping playback (e.g. as
+     * chunks of a resynthesis arrive). Samples past the end are dropped.
+     */
+    void updateWaveformRegion(int startSample, const float* samples, int numSamples);
+    
     void play();
     void pause();
     void stop();
@@ -64,10 +71,12 @@ private:
     
     double currentSampleRate = 44100.0;
     
-    // For sample rate conversion
-    juce::LagrangeInterpolator interpolator;
+    // For sample rate conversion (waveform rate -> device rate)
+    void prepareResampler();
+    
+    std::unique_ptr<Resampler> resampler;
+    juce::SpinLock resamplerLock;  // Held by the audio callback while it streams
     double playbackRatio = 1.0;  // waveformSampleRate / deviceSampleRate
-    double fractionalPosition = 0.0;  // Sub-sample position for interpolation
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioEngine)
 };
@@ -0,0 +1,59 @@
+#include "AudioImport.h"
+#include "../Utils/Resampler.h"
+
+namespace AudioImport
+{
+    bool readMono(juce::AudioFormatReader& reader, juce::AudioBuffer<float>& buffer)
+    {
+        const int numSamples = static_cast<int>(reader.lengthInSamples);
+        if (numSamples <= 0)
+            return false;
+
+        buffer.setSize(1, numSamples);
+
+        if (reader.numChannels == 1)
+            return reader.read(&buffer, 0, numSamples, 0, true, false);
+
+        juce::AudioBuffer<float> stereoBuffer(2, numSamples);
+        if (!reader.read(&stereoBuffer, 0, numSamples, 0, true, true))
+            return false;
+
+        const float* left = stereoBuffer.getReadPointer(0);
+        const float* right = stereoBuffer.getReadPointer(1);
+        float* mono = buffer.getWritePointer(0);
+
+        for (int i = 0; i < numSamples; ++i)
+            mono[i] = (left[i] + right[i]) * 0.5f;
+
+        return true;
+    }
+
+    void resample(juce::AudioBuffer<float>& buffer, int sourceRate, int targetRate)
+    {
+        if (sourceRate == targetRate)
+            return;
+
+        const Resampler resampler(sourceRate, targetRate);
+        const int numSamples = buffer.getNumSamples();
+        const int newNumSamples = resampler.getOutputLength(numSamples);
+
+        juce::AudioBuffer<float> resampledBuffer(1, newNumSamples);
+        resampler.processBlock(buffer.getReadPointer(0), numSamples,
+                               resampledBuffer.getWritePointer(0), newNumSamples);
+
+        buffer = std::move(resampledBuffer);
+    }
+
+    int64_t estimateMemoryBytes(const juce::AudioFormatReader& reader, int targetRate)
+    {
+        const int64_t numSamples = reader.lengthInSamples;
+        const int64_t channels = reader.numChannels == 1 ? 1 : 2;
+        const int64_t numTarget = reader.sampleRate > 0
+                                      ? static_cast<int64_t>(numSamples * (targetRate / reader.sampleRate))
+                                      : numSamples;
+
+        // Source channels + mono mix while reading, then mono + resampled
+        return static_cast<int64_t>(sizeof(float))
+             * std::max(numSamples * (channels + 1), numSamples + numTarget);
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "../JuceHeader.h"
+
+/**
+ * Reading audio files into the mono buffers the analysis runs on.
+ *
+ * Shared by interactive loading and batch analysis so both produce the same
+ * samples, and with them the same analysis cache keys.
+ */
+namespace AudioImport
+{
+    /**
+     * Read the whole file as one channel (stereo and wider are averaged
+     * over the first two channels).
+     * @return false if the file is empty or could not be read
+     */
+    bool readMono(juce::AudioFormatReader& reader, juce::AudioBuffer<float>& buffer);
+
+    /** Resample buffer's first channel in place (polyphase, see Resampler). */
+    void resample(juce::AudioBuffer<float>& buffer, int sourceRate, int targetRate);
+
+    /** Bytes readMono and resample to targetRate hold at their peak. */
+    int64_t estimateMemoryBytes(const juce::AudioFormatReader& reader, int targetRate);
+}
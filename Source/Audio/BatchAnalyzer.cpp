@@ -0,0 +1,285 @@
+#include "BatchAnalyzer.h"
+#include "AudioImport.h"
+#include "../Utils/Constants.h"
+#include "../Utils/MelSpectrogram.h"
+#include <algorithm>
+
+namespace
+{
+    // Per-session cost beyond the model file: ORT arena, optimized graph copies
+    constexpr int64_t sessionOverheadBytes = 64LL * 1024 * 1024;
+    constexpr int modelSizeMultiplier = 3;
+}
+
+BatchAnalyzer::BatchAnalyzer(AnalysisCache& cache, const FCPEPitchDetector& settings, Options opts)
+    : cache(cache),
+      options(std::move(opts))
+{
+    const int hardwareThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    auto [numSessions, threadsPerSession] = getDefaultSizing(hardwareThreads);
+
+    if (options.maxSessions > 0)
+    {
+        numSessions = options.maxSessions;
+        threadsPerSession = std::max(1, hardwareThreads / numSessions);
+    }
+    if (options.intraOpThreads > 0)
+        threadsPerSession = options.intraOpThreads;
+
+    // Leave at least half the budget for the files themselves
+    const int64_t bytesPerSession = options.modelFile.getSize() * modelSizeMultiplier + sessionOverheadBytes;
+    const int64_t sessionBudget = std::max<int64_t>(1, options.memoryBudgetBytes / 2);
+    numSessions = static_cast<int>(std::clamp<int64_t>(sessionBudget / bytesPerSession, 1, numSessions));
+
+    intraOpThreads = threadsPerSession;
+
+    for (int i = 0; i < numSessions; ++i)
+    {
+        auto detector = std::make_unique<FCPEPitchDetector>();
+        detector->copySettingsFrom(settings);
+        detector->setIntraOpThreads(intraOpThreads);
+
+        // Files already run in parallel; the shared pool would only oversubscribe
+        detector->setMultithreaded(false);
+        sessions.push_back(std::move(detector));
+    }
+
+    DBG("BatchAnalyzer: " << numSessions << " sessions x " << intraOpThreads << " intra-op threads");
+}
+
+BatchAnalyzer::~BatchAnalyzer()
+{
+    cancel();
+
+    for (auto& worker : workers)
+        if (worker.joinable())
+            worker.join();
+}
+
+std::pair<int, int> BatchAnalyzer::getDefaultSizing(int hardwareThreads)
+{
+    hardwareThreads = std::max(1, hardwareThreads);
+    const int numSessions = std::max(1, hardwareThreads / 2);
+    return { numSessions, std::max(1, hardwareThreads / numSessions) };
+}
+
+bool BatchAnalyzer::start()
+{
+    if (!workers.empty())
+        return true;
+
+    for (auto& session : sessions)
+    {
+        if (!session->loadModel(options.modelFile, options.melFilterbankFile, options.centTableFile))
+        {
+            DBG("BatchAnalyzer: failed to load " + options.modelFile.getFullPathName());
+            return false;
+        }
+    }
+
+    for (int i = 0; i < static_cast<int>(sessions.size()); ++i)
+        workers.emplace_back([this, i]() { workerLoop(i); });
+
+    return true;
+}
+
+void BatchAnalyzer::addFiles(const juce::Array<juce::File>& files)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping)
+            return;
+
+        for (const auto& file : files)
+            queue.push_back(file);
+    }
+    queueChanged.notify_all();
+}
+
+void BatchAnalyzer::cancel()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.clear();
+        stopping = true;
+    }
+    queueChanged.notify_all();
+    memoryReleased.notify_all();
+}
+
+void BatchAnalyzer::waitUntilIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    queueChanged.wait(lock, [this]()
+    {
+        return numInProgress == 0 && (queue.empty() || stopping || workers.empty());
+    });
+}
+
+void BatchAnalyzer::setFileCallback(FileCallback callback)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    fileCallback = std::move(callback);
+}
+
+int BatchAnalyzer::getNumQueued() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<int>(queue.size());
+}
+
+double BatchAnalyzer::getProgress() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const int finished = numFinished.load();
+    const int total = finished + static_cast<int>(queue.size()) + numInProgress;
+    return total > 0 ? static_cast<double>(finished) / total : 1.0;
+}
+
+bool BatchAnalyzer::isBusy() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return numInProgress > 0 || (!queue.empty() && !stopping);
+}
+
+void BatchAnalyzer::workerLoop(int sessionIndex)
+{
+    auto& detector = *sessions[static_cast<size_t>(sessionIndex)];
+
+    for (;;)
+    {
+        juce::File file;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queueChanged.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (stopping)
+                return;
+
+            file = queue.front();
+            queue.pop_front();
+            ++numInProgress;
+        }
+
+        const auto result = analyzeFile(file, detector);
+
+        ++numFinished;
+        if (!result.ok)
+            ++numFailed;
+
+        FileCallback callback;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            callback = fileCallback;
+        }
+        if (callback)
+            callback(result);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --numInProgress;
+        }
+        queueChanged.notify_all();
+    }
+}
+
+BatchAnalyzer::FileResult BatchAnalyzer::analyzeFile(const juce::File& file, FCPEPitchDetector& detector)
+{
+    FileResult result;
+    result.file = file;
+    const double startMs = juce::Time::getMillisecondCounterHiRes();
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+    if (reader == nullptr || reader->sampleRate <= 0.0)
+    {
+        result.error = "Unsupported or unreadable file";
+        return result;
+    }
+
+    // Working set: decoding, the vocoder mel and FCPE inference
+    const int srcSampleRate = static_cast<int>(reader->sampleRate);
+    const int numSamples = static_cast<int>(reader->lengthInSamples * (static_cast<double>(SAMPLE_RATE) / reader->sampleRate));
+    const int64_t melBytes = static_cast<int64_t>(numSamples / HOP_SIZE + 1) * NUM_MELS * static_cast<int64_t>(sizeof(float));
+    const int64_t bytes = AudioImport::estimateMemoryBytes(*reader, SAMPLE_RATE) + melBytes
+                        + detector.estimateMemoryBytes(numSamples, SAMPLE_RATE);
+
+    if (!acquireMemory(bytes))
+    {
+        result.error = "Cancelled";
+        return result;
+    }
+
+    AudioData audioData;
+    if (AudioImport::readMono(*reader, audioData.waveform))
+    {
+        reader.reset();
+        AudioImport::resample(audioData.waveform, srcSampleRate, SAMPLE_RATE);
+
+        // Same key as MainComponent::analyzeAudio
+        const float* samples = audioData.waveform.getReadPointer(0);
+        const int numResampled = audioData.waveform.getNumSamples();
+        const uint64_t key = AnalysisCache::makeKey(samples, numResampled,
+                                                    detector.getDetectorName(), detector.getSettingsHash());
+
+        if (cache.contains(key))
+        {
+            result.ok = true;
+            result.fromCache = true;
+        }
+        else
+        {
+            MelSpectrogram melComputer(SAMPLE_RATE, N_FFT, HOP_SIZE, NUM_MELS, FMIN, FMAX);
+            melComputer.setMultithreaded(false);
+            audioData.melSpectrogram = melComputer.compute(samples, numResampled, MelMatrix::Layout::MelMajor);
+
+            auto [f0Values, voicedValues] = detector.detectF0(samples, numResampled, SAMPLE_RATE, HOP_SIZE,
+                                                              audioData.melSpectrogram.getNumFrames());
+            audioData.f0 = std::move(f0Values);
+            audioData.voicedMask = std::move(voicedValues);
+
+            if (audioData.f0.empty())
+                result.error = "Pitch detection failed";
+            else if (!cache.store(key, audioData))
+                result.error = "Could not write the analysis cache";
+            else
+                result.ok = true;
+        }
+    }
+    else
+    {
+        result.error = "Could not read audio";
+    }
+
+    releaseMemory(bytes);
+
+    result.seconds = (juce::Time::getMillisecondCounterHiRes() - startMs) / 1000.0;
+    DBG("BatchAnalyzer: " << file.getFileName() << (result.ok ? juce::String(" done") : " failed: " + result.error)
+        << " in " << result.seconds << " s");
+    return result;
+}
+
+bool BatchAnalyzer::acquireMemory(int64_t bytes)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    memoryReleased.wait(lock, [this, bytes]()
+    {
+        return stopping || memoryInUse == 0 || memoryInUse + bytes <= options.memoryBudgetBytes;
+    });
+
+    if (stopping)
+        return false;
+
+    memoryInUse += bytes;
+    return true;
+}
+
+void BatchAnalyzer::releaseMemory(int64_t bytes)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        memoryInUse -= bytes;
+    }
+    memoryReleased.notify_all();
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "FCPEPitchDetector.h"
+#include "../Models/AnalysisCache.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Background FCPE analysis of many audio files into the AnalysisCache, so
+ * opening them later restores mel and F0 instead of analyzing.
+ *
+ * Owns a pool of FCPE sessions, one worker thread each, fed from a queue of
+ * files. Sessions x intra-op threads is sized to the machine: whole files in
+ * parallel scale better than one large Run, so by default every two hardware
+ * threads get a session. Files only start while their estimated working
+ * memory fits the budget (a file larger than the whole budget runs alone),
+ * and the session count is reduced so the loaded models leave room for them.
+ *
+ * Each file goes through the same loading and analysis as opening it
+ * interactively (AudioImport, mel spectrogram, FCPEPitchDetector::detectF0),
+ * so its entry is the one MainComponent looks up. Files that already have an
+ * entry are skipped.
+ */
+class BatchAnalyzer
+{
+public:
+    static constexpr int64_t defaultMemoryBudgetBytes = 4LL * 1024 * 1024 * 1024;
+
+    struct Options
+    {
+        juce::File modelFile;                 // fcpe.onnx
+        juce::File melFilterbankFile;         // Optional, as FCPEPitchDetector::loadModel
+        juce::File centTableFile;             // Optional
+
+        int maxSessions = 0;                  // 0 = from hardware threads
+        int intraOpThreads = 0;               // 0 = hardware threads / sessions
+        int64_t memoryBudgetBytes = defaultMemoryBudgetBytes;
+    };
+
+    struct FileResult
+    {
+        juce::File file;
+        bool ok = false;
+        bool fromCache = false;               // Already analyzed, skipped
+        juce::String error;
+        double seconds = 0.0;                 // Wall time for this file
+    };
+
+    /** Called on a worker thread after each file. */
+    using FileCallback = std::function<void(const FileResult&)>;
+
+    /**
+     * @param cache Destination of the results; must outlive the analyzer
+     * @param settings Chunking, silence gate and decoder to analyze with
+     *                 (see FCPEPitchDetector::copySettingsFrom)
+     */
+    BatchAnalyzer(AnalysisCache& cache, const FCPEPitchDetector& settings, Options options);
+
+    /** Cancels and waits for the workers. */
+    ~BatchAnalyzer();
+
+    /**
+     * Load the sessions and start the workers (idempotent).
+     * @return false if the model could not be loaded
+     */
+    bool start();
+
+    /** Queue files for analysis; may be called before or after start(). */
+    void addFiles(const juce::Array<juce::File>& files);
+
+    /** Drop the queued files and stop after the files in progress. */
+    void cancel();
+
+    /** Block until the queue is empty and no file is in progress. */
+    void waitUntilIdle();
+
+    void setFileCallback(FileCallback callback);
+
+    int getNumSessions() const { return static_cast<int>(sessions.size()); }
+    int getIntraOpThreads() const { return intraOpThreads; }
+    int getNumQueued() const;
+    int getNumFinished() const { return numFinished.load(); }
+    int getNumFailed() const { return numFailed.load(); }
+
+    /** Files finished / (finished + queued + in progress); 1 when idle. */
+    double getProgress() const;
+    bool isBusy() const;
+
+    /**
+     * Sessions and intra-op threads for a machine with hardwareThreads
+     * threads, before the memory budget is applied.
+     */
+    static std::pair<int, int> getDefaultSizing(int hardwareThreads);
+
+private:
+    void workerLoop(int sessionIndex);
+    FileResult analyzeFile(const juce::File& file, FCPEPitchDetector& detector);
+
+    /** Reserve bytes of the memory budget, waiting for running files to release it. */
+    bool acquireMemory(int64_t bytes);
+    void releaseMemory(int64_t bytes);
+
+    AnalysisCache& cache;
+    Options options;
+    int intraOpThreads = 1;
+
+    std::vector<std::unique_ptr<FCPEPitchDetector>> sessions;
+    std::vector<std::thread> workers;
+
+    mutable std::mutex mutex;
+    std::condition_variable queueChanged;    // Files queued, a file finished, or cancel
+    std::condition_variable memoryReleased;
+    std::deque<juce::File> queue;
+    int numInProgress = 0;
+    int64_t memoryInUse = 0;
+    bool stopping = false;
+    FileCallback fileCallback;
+
+    std::atomic<int> numFinished { 0 };
+    std::atomic<int> numFailed { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BatchAnalyzer)
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+/**
+ * Common interface of the pitch detectors (FCPEPitchDetector, and
+ * PitchDetector's YIN), so analysis and region re-detection can run either.
+ *
+ * Every detector reports F0 on the caller's frame grid: frame t belongs to
+ * sample t * hopSize of the audio it was given. Because frames are anchored
+ * to the start of the buffer, detecting a slice that starts on a frame
+ * boundary gives frames that line up with the whole-file analysis.
+ */
+class F0Detector
+{
+public:
+    /** Called as work completes (e.g. once per inference chunk). */
+    using ProgressCallback = std::function<void(int done, int total)>;
+
+    virtual ~F0Detector() = default;
+
+    /** "fcpe" / "yin": names the detector in the analysis cache and config. */
+    virtual const char* getDetectorName() const = 0;
+
+    /** False until the detector can run (e.g. its model is loaded). */
+    virtual bool isReady() const = 0;
+
+    /** Hash of every setting that affects detectF0 (for analysis caching). */
+    virtual uint64_t getSettingsHash() const = 0;
+
+    /**
+     * F0 of audio at sampleRate, as numFrames frames hopSize samples apart.
+     * @return Pair of (f0 in Hz, 0 where unvoiced; voiced mask), numFrames
+     *         each, or empty if detection failed
+     */
+    virtual std::pair<std::vector<float>, std::vector<bool>>
+    detectF0(const float* audio, int numSamples, int sampleRate, int hopSize, int numFrames,
+             const ProgressCallback& onProgress = nullptr) = 0;
+};
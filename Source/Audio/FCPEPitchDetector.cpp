@@ -1,12 +1,34 @@
 #include "FCPEPitchDetector.h"
+#include "../Utils/ActivityMap.h"
+#include "../Utils/ContentHash.h"
+#include "../Utils/Resampler.h"
+#include "../Utils/SimdMath.h"
+#include "../Utils/WorkerPool.h"
 #include <cmath>
 #include <algorithm>
 #include <numeric>
 
+/**
+ * Input and output of one inference chunk. Both grow to the largest chunk
+ * seen and are re-bound in place, so repeated analyses (re-detecting a
+ * selection, batches of files) don't reallocate them.
+ */
+struct FCPEPitchDetector::InferenceContext
+{
+#ifdef HAVE_ONNXRUNTIME
+    explicit InferenceContext(Ort::Session& session) : binding(session) {}
+    
+    Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
+    Ort::IoBinding binding;
+#endif
+    
+    MelMatrix mel { 0, N_MELS, MelMatrix::Layout::FrameMajor };  // [T, N_MELS]
+    std::vector<float> output;                                     // [T, OUT_DIMS]
+};
+
 FCPEPitchDetector::FCPEPitchDetector()
 {
     initMelFilterbank();
-    initHannWindow();
     initCentTable();
 }
 
@@ -46,10 +68,10 @@ void FCPEPitchDetector::initMelFilterbank()
     }
     
     // Create filterbank with Slaney normalization
-    melFilterbank.resize(N_MELS);
+    std::vector<float> dense(static_cast<size_t>(N_MELS) * numBins, 0.0f);
     for (int m = 0; m < N_MELS; ++m)
     {
-        melFilterbank[m].resize(numBins, 0.0f);
+        float* row = dense.data() + static_cast<size_t>(m) * numBins;
         
         float fLow = hzPoints[m];
         float fCenter = hzPoints[m + 1];
@@ -64,24 +86,43 @@ void FCPEPitchDetector::initMelFilterbank()
             
             if (freq >= fLow && freq < fCenter)
             {
-                melFilterbank[m][k] = enorm * (freq - fLow) / (fCenter - fLow);
+                row[k] = enorm * (freq - fLow) / (fCenter - fLow);
             }
             else if (freq >= fCenter && freq <= fHigh)
             {
-                melFilterbank[m][k] = enorm * (fHigh - freq) / (fHigh - fCenter);
+                row[k] = enorm * (fHigh - freq) / (fHigh - fCenter);
             }
         }
     }
+    
+    setMelFilterbank(MelFilterbank::fromDense(dense.data(), N_MELS, numBins));
 }
 
-void FCPEPitchDetector::initHannWindow()
+STFT::Config FCPEPitchDetector::getSTFTConfig()
 {
-    // Create Hann window (numpy.hanning style - symmetric)
-    hannWindow.resize(WIN_SIZE);
-    for (int i = 0; i < WIN_SIZE; ++i)
-    {
-        hannWindow[i] = 0.5f * (1.0f - std::cos(2.0f * juce::MathConstants<float>::pi * i / (WIN_SIZE - 1)));
-    }
+    // Symmetric Hann (numpy.hanning) and (WIN - HOP) / 2 reflect padding, as in PyTorch FCPE
+    STFT::Config config;
+    config.sampleRate = FCPE_SAMPLE_RATE;
+    config.nFft = N_FFT;
+    config.winSize = WIN_SIZE;
+    config.hopSize = HOP_SIZE;
+    config.window = STFT::WindowType::HannSymmetric;
+    config.padding = STFT::PaddingMode::Reflect;
+    config.centering = STFT::Centering::HalfOverlap;
+    return config;
+}
+
+void FCPEPitchDetector::setMelFilterbank(MelFilterbank filterbank)
+{
+    melExtractor = std::make_unique<MelSpectrogram>(getSTFTConfig(), std::move(filterbank), 1e-9f, CLIP_VAL);
+    melExtractor->setMultithreaded(multithreaded);
+}
+
+void FCPEPitchDetector::setMultithreaded(bool shouldUseWorkerPool)
+{
+    multithreaded = shouldUseWorkerPool;
+    if (melExtractor)
+        melExtractor->setMultithreaded(shouldUseWorkerPool);
 }
 
 void FCPEPitchDetector::initCentTable()
@@ -112,18 +153,13 @@ bool FCPEPitchDetector::loadModel(const juce::File& modelPath,
             {
                 const int numBins = N_FFT / 2 + 1;
                 std::vector<float> data(N_MELS * numBins);
-                stream.read(data.data(), data.size() * sizeof(float));
+                stream.read(data.data(), static_cast<int>(data.size() * sizeof(float)));
                 
-                melFilterbank.resize(N_MELS);
-                for (int m = 0; m < N_MELS; ++m)
-                {
-                    melFilterbank[m].resize(numBins);
-                    for (int k = 0; k < numBins; ++k)
-                    {
-                        melFilterbank[m][k] = data[m * numBins + k];
-                    }
-                }
-                DBG("Loaded mel filterbank from file");
+                // Same sparse band form as the computed filterbank
+                auto filterbank = MelFilterbank::fromDense(data.data(), N_MELS, numBins);
+                DBG("Loaded mel filterbank from file (" << filterbank.getNumStoredWeights()
+                    << " non-zero-span weights)");
+                setMelFilterbank(std::move(filterbank));
             }
         }
         
@@ -139,11 +175,14 @@ bool FCPEPitchDetector::loadModel(const juce::File& modelPath,
             }
         }
         
+        // The old binding refers to the session being replaced
+        inferenceContext.reset();
+        
         // Initialize ONNX Runtime
         onnxEnv = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "FCPEPitchDetector");
         
         Ort::SessionOptions sessionOptions;
-        sessionOptions.SetIntraOpNumThreads(1);
+        sessionOptions.SetIntraOpNumThreads(intraOpThreads);
         sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
         
 #ifdef _WIN32
@@ -182,6 +221,21 @@ bool FCPEPitchDetector::loadModel(const juce::File& modelPath,
         for (const auto& name : outputNameStrings)
             outputNames.push_back(name.c_str());
         
+        inferenceContext = std::make_unique<InferenceContext>(*onnxSession);
+        
+        // Identify this model (and its tables) for cached analysis results
+        ContentHash hash;
+        for (const auto& file : { modelPath, melFilterbankPath, centTablePath })
+        {
+            if (!file.existsAsFile())
+                continue;
+            
+            juce::MemoryMappedFile mapped(file, juce::MemoryMappedFile::readOnly);
+            if (mapped.getData() != nullptr)
+                hash.update(mapped.getData(), mapped.getSize());
+        }
+        modelHash = hash.getHash();
+        
         loaded = true;
         DBG("FCPE model loaded successfully");
         return true;
@@ -211,183 +265,355 @@ std::vector<float> FCPEPitchDetector::resampleTo16k(const float* audio, int numS
         return std::vector<float>(audio, audio + numSamples);
     }
     
-    // Simple linear interpolation resampling
-    // For production, consider using a proper resampler (e.g., libsamplerate)
-    double ratio = static_cast<double>(FCPE_SAMPLE_RATE) / srcRate;
-    int outSamples = static_cast<int>(numSamples * ratio);
+    // Polyphase windowed-sinc: the low-pass at 8 kHz keeps the upper band from
+    // aliasing into the mel bins the model sees
+    return Resampler(srcRate, FCPE_SAMPLE_RATE).processBlock(audio, numSamples);
+}
+
+MelMatrix FCPEPitchDetector::extractMel(const std::vector<float>& audio)
+{
+    // Padding, windowing and FFT plans come from the shared STFT engine
+    return melExtractor->compute(audio.data(), static_cast<int>(audio.size()), MelMatrix::Layout::FrameMajor);
+}
+
+void FCPEPitchDetector::decodeF0(const float* latent, int numFrames, float threshold, float* f0) const
+{
+    if (decodeMode == DecodeMode::Viterbi)
+    {
+        decodeViterbi(latent, numFrames, threshold, f0);
+        return;
+    }
     
-    std::vector<float> resampled(outSamples);
+    const int numBlocks = (numFrames + framesPerDecodeBlock - 1) / framesPerDecodeBlock;
     
-    for (int i = 0; i < outSamples; ++i)
+    if (!multithreaded || numBlocks <= 1)
     {
-        double srcPos = i / ratio;
-        int srcIdx = static_cast<int>(srcPos);
-        double frac = srcPos - srcIdx;
-        
-        if (srcIdx + 1 < numSamples)
-        {
-            resampled[i] = static_cast<float>(audio[srcIdx] * (1.0 - frac) + audio[srcIdx + 1] * frac);
-        }
-        else if (srcIdx < numSamples)
-        {
-            resampled[i] = audio[srcIdx];
-        }
+        decodeFrames(latent, 0, numFrames, threshold, f0);
+        return;
     }
     
-    return resampled;
+    // Frames are independent; each block writes its own slice of f0
+    WorkerPool::getInstance().parallelFor(numBlocks, [&](int block, int)
+    {
+        const int start = block * framesPerDecodeBlock;
+        const int end = std::min(numFrames, start + framesPerDecodeBlock);
+        decodeFrames(latent, start, end, threshold, f0);
+    });
 }
 
-std::vector<std::vector<float>> FCPEPitchDetector::extractMel(const std::vector<float>& audio)
+void FCPEPitchDetector::decodeFrames(const float* latent, int startFrame, int endFrame,
+                                     float threshold, float* f0) const
 {
-    const int numBins = N_FFT / 2 + 1;
-    
-    // Pad audio (same as PyTorch FCPE)
-    int padLeft = (WIN_SIZE - HOP_SIZE) / 2;
-    int padRight = std::max((WIN_SIZE - HOP_SIZE + 1) / 2, 
-                            WIN_SIZE - static_cast<int>(audio.size()) - padLeft);
-    
-    std::vector<float> paddedAudio;
-    
-    // Reflect padding if possible, otherwise zero padding
-    if (padRight < static_cast<int>(audio.size()))
+    for (int t = startFrame; t < endFrame; ++t)
     {
-        // Reflect padding
-        paddedAudio.reserve(padLeft + audio.size() + padRight);
-        
-        // Left reflection
-        for (int i = padLeft; i > 0; --i)
-        {
-            paddedAudio.push_back(audio[std::min(i, static_cast<int>(audio.size()) - 1)]);
-        }
+        const float* frame = latent + static_cast<size_t>(t) * OUT_DIMS;
         
-        // Original audio
-        paddedAudio.insert(paddedAudio.end(), audio.begin(), audio.end());
+        // Find max index and confidence
+        float maxVal = 0.0f;
+        const int maxIdx = SimdMath::argMax(frame, OUT_DIMS, maxVal);
         
-        // Right reflection
-        int audioSize = static_cast<int>(audio.size());
-        for (int i = 0; i < padRight; ++i)
-        {
-            int idx = audioSize - 2 - i;
-            if (idx < 0) idx = 0;
-            paddedAudio.push_back(audio[idx]);
-        }
+        // Check confidence threshold
+        f0[t] = maxVal > threshold ? decodeAroundBin(frame, maxIdx) : 0.0f;
     }
-    else
+}
+
+float FCPEPitchDetector::decodeAroundBin(const float* frame, int centreBin) const
+{
+    // Local argmax decoder: weighted average around the centre bin
+    int localStart = std::max(0, centreBin - 4);
+    int localEnd = std::min(OUT_DIMS - 1, centreBin + 4);
+    
+    float weightedSum = 0.0f;
+    float weightSum = 0.0f;
+    
+    for (int i = localStart; i <= localEnd; ++i)
+    {
+        weightedSum += centTable[i] * frame[i];
+        weightSum += frame[i];
+    }
+    
+    if (weightSum > 1e-9f)
     {
-        // Zero padding
-        paddedAudio.resize(padLeft + audio.size() + padRight, 0.0f);
-        std::copy(audio.begin(), audio.end(), paddedAudio.begin() + padLeft);
+        float cent = weightedSum / weightSum;
+        return centToF0(cent);
     }
     
-    // Calculate number of frames
-    int numFrames = 1 + (static_cast<int>(paddedAudio.size()) - WIN_SIZE) / HOP_SIZE;
-    if (numFrames < 1) numFrames = 1;
+    return 0.0f;
+}
+
+//==============================================================================
+namespace
+{
+    // Stands in for -inf outside the bins (keeps the max-plus arithmetic finite)
+    constexpr float viterbiFloorScore = -1.0e30f;
     
-    std::vector<std::vector<float>> mel(numFrames);
+    // Bin activations below this count as this (log 1e-5 = -11.5)
+    constexpr float viterbiMinActivation = 1.0e-5f;
     
-    // FFT buffer (real + imaginary interleaved for JUCE FFT)
-    std::vector<float> fftBuffer(N_FFT * 2, 0.0f);
-    juce::dsp::FFT fft(static_cast<int>(std::log2(N_FFT)));
+    // Scores drift by at most ~16 per frame; re-centring this often keeps
+    // them well inside float precision
+    constexpr int viterbiRenormaliseFrames = 16;
     
-    for (int frame = 0; frame < numFrames; ++frame)
+    /** log transition weight by jump size |d|: triangular, (band + 1 - |d|) / (band + 1)^2. */
+    std::vector<float> makeViterbiWeights(int band)
     {
-        int start = frame * HOP_SIZE;
-        
-        // Apply window and prepare FFT input
-        std::fill(fftBuffer.begin(), fftBuffer.end(), 0.0f);
-        for (int i = 0; i < WIN_SIZE && start + i < static_cast<int>(paddedAudio.size()); ++i)
-        {
-            fftBuffer[i] = paddedAudio[start + i] * hannWindow[i];
-        }
-        
-        // Perform FFT
-        fft.performRealOnlyForwardTransform(fftBuffer.data());
-        
-        // Compute magnitude spectrum
-        std::vector<float> mag(numBins);
-        for (int k = 0; k < numBins; ++k)
-        {
-            float real = fftBuffer[k * 2];
-            float imag = fftBuffer[k * 2 + 1];
-            mag[k] = std::sqrt(real * real + imag * imag + 1e-9f);
-        }
+        std::vector<float> weights(static_cast<size_t>(band) + 1);
+        const double norm = static_cast<double>(band + 1) * (band + 1);
+        for (int d = 0; d <= band; ++d)
+            weights[static_cast<size_t>(d)] = static_cast<float>(std::log((band + 1 - d) / norm));
+        return weights;
+    }
+    
+    /** The jump d into bin j that maxPlusBanded picked (ties: smaller |d|, then -d). */
+    int bestViterbiJump(const float* prev, const float* weights, int band, int j)
+    {
+        float best = prev[j] + weights[0];
+        int bestJump = 0;
         
-        // Apply mel filterbank
-        mel[frame].resize(N_MELS);
-        for (int m = 0; m < N_MELS; ++m)
+        for (int d = 1; d <= band; ++d)
         {
-            float sum = 0.0f;
-            for (int k = 0; k < numBins; ++k)
+            if (prev[j - d] + weights[d] > best)
             {
-                sum += mag[k] * melFilterbank[m][k];
+                best = prev[j - d] + weights[d];
+                bestJump = -d;
+            }
+            if (prev[j + d] + weights[d] > best)
+            {
+                best = prev[j + d] + weights[d];
+                bestJump = d;
             }
-            
-            // Dynamic range compression (log)
-            mel[frame][m] = std::log(std::max(sum, CLIP_VAL));
         }
+        
+        return bestJump;
+    }
+}
+
+struct FCPEPitchDetector::ViterbiScratch
+{
+    std::vector<float> scores;     // [frames][OUT_DIMS], each row padded by viterbiBand on both sides
+    std::vector<float> emission;   // [OUT_DIMS]
+};
+
+void FCPEPitchDetector::decodeViterbi(const float* latent, int numFrames, float threshold, float* f0) const
+{
+    const int numChunks = (numFrames + viterbiChunkFrames - 1) / viterbiChunkFrames;
+    
+    // Chunks overlap by their context and each keeps only its own frames
+    auto decodeChunk = [&](int chunk, ViterbiScratch& scratch)
+    {
+        const int keepStart = chunk * viterbiChunkFrames;
+        const int keepEnd = std::min(numFrames, keepStart + viterbiChunkFrames);
+        const int start = std::max(0, keepStart - viterbiContextFrames);
+        const int end = std::min(numFrames, keepEnd + viterbiContextFrames);
+        
+        decodeViterbiChunk(latent + static_cast<size_t>(start) * OUT_DIMS, end - start,
+                           keepStart - start, keepEnd - start, threshold, f0 + start, scratch);
+    };
+    
+    if (!multithreaded || numChunks <= 1)
+    {
+        ViterbiScratch scratch;
+        for (int chunk = 0; chunk < numChunks; ++chunk)
+            decodeChunk(chunk, scratch);
+        return;
     }
     
-    return mel;
+    auto& pool = WorkerPool::getInstance();
+    std::vector<ViterbiScratch> scratch(static_cast<size_t>(pool.getMaxConcurrency()));
+    
+    pool.parallelFor(numChunks, [&](int chunk, int worker)
+    {
+        decodeChunk(chunk, scratch[static_cast<size_t>(worker)]);
+    });
 }
 
-std::vector<float> FCPEPitchDetector::decodeF0(const std::vector<std::vector<float>>& latent,
-                                                 float threshold)
+void FCPEPitchDetector::decodeViterbiChunk(const float* latent, int numFrames, int keepStart, int keepEnd,
+                                           float threshold, float* f0, ViterbiScratch& scratch) const
 {
-    int numFrames = static_cast<int>(latent.size());
-    std::vector<float> f0(numFrames, 0.0f);
+    static const std::vector<float> weights = makeViterbiWeights(viterbiBand);
     
-    for (int t = 0; t < numFrames; ++t)
+    if (numFrames <= 0)
+        return;
+    
+    const size_t paddedSize = static_cast<size_t>(OUT_DIMS + 2 * viterbiBand);
+    scratch.scores.assign(static_cast<size_t>(numFrames) * paddedSize, viterbiFloorScore);
+    scratch.emission.resize(OUT_DIMS);
+    
+    auto getScores = [&](int t) { return scratch.scores.data() + static_cast<size_t>(t) * paddedSize + viterbiBand; };
+    float* emission = scratch.emission.data();
+    
+    auto computeEmission = [&](int t)
+    {
+        std::copy(latent + static_cast<size_t>(t) * OUT_DIMS, latent + static_cast<size_t>(t + 1) * OUT_DIMS, emission);
+        SimdMath::logClamped(emission, OUT_DIMS, viterbiMinActivation);
+    };
+    
+    // Forward pass: best log score of each bin per frame, renormalised to a
+    // peak of 0 every few frames. The rows are kept so the backtrack can
+    // recover the jumps.
+    computeEmission(0);
+    std::copy(emission, emission + OUT_DIMS, getScores(0));
+    
+    for (int t = 1; t < numFrames; ++t)
     {
-        const auto& frame = latent[t];
+        float* scores = getScores(t);
+        SimdMath::maxPlusBanded(getScores(t - 1), weights.data(), viterbiBand, OUT_DIMS, scores);
         
-        // Find max index and confidence
-        int maxIdx = 0;
-        float maxVal = frame[0];
-        for (int i = 1; i < OUT_DIMS; ++i)
-        {
-            if (frame[i] > maxVal)
-            {
-                maxVal = frame[i];
-                maxIdx = i;
-            }
-        }
+        computeEmission(t);
+        juce::FloatVectorOperations::add(scores, emission, OUT_DIMS);
         
-        // Check confidence threshold
-        if (maxVal <= threshold)
+        if (t % viterbiRenormaliseFrames == 0)
         {
-            f0[t] = 0.0f;
-            continue;
+            float peak = 0.0f;
+            SimdMath::argMax(scores, OUT_DIMS, peak);
+            juce::FloatVectorOperations::add(scores, -peak, OUT_DIMS);
         }
-        
-        // Local argmax decoder: weighted average around max index
-        int localStart = std::max(0, maxIdx - 4);
-        int localEnd = std::min(OUT_DIMS - 1, maxIdx + 4);
-        
-        float weightedSum = 0.0f;
-        float weightSum = 0.0f;
-        
-        for (int i = localStart; i <= localEnd; ++i)
+    }
+    
+    // Backtrack from the best final bin
+    float bestScore = 0.0f;
+    int bin = SimdMath::argMax(getScores(numFrames - 1), OUT_DIMS, bestScore);
+    
+    for (int t = numFrames - 1; t >= keepStart; --t)
+    {
+        if (t < keepEnd)
         {
-            weightedSum += centTable[i] * frame[i];
-            weightSum += frame[i];
+            const float* frame = latent + static_cast<size_t>(t) * OUT_DIMS;
+            
+            // Voicing as in the local decoder, pitch around the path bin
+            float maxVal = 0.0f;
+            SimdMath::argMax(frame, OUT_DIMS, maxVal);
+            f0[t] = maxVal > threshold ? decodeAroundBin(frame, bin) : 0.0f;
         }
         
-        if (weightSum > 1e-9f)
-        {
-            float cent = weightedSum / weightSum;
-            f0[t] = centToF0(cent);
-        }
-        else
+        if (t > 0)
+            bin += bestViterbiJump(getScores(t - 1), weights.data(), viterbiBand, bin);
+    }
+}
+
+//==============================================================================
+const char* FCPEPitchDetector::getDecodeModeName(DecodeMode mode)
+{
+    return mode == DecodeMode::Viterbi ? "viterbi" : "argmax";
+}
+
+bool FCPEPitchDetector::parseDecodeModeName(const juce::String& name, DecodeMode& mode)
+{
+    for (auto candidate : { DecodeMode::LocalArgmax, DecodeMode::Viterbi })
+    {
+        if (name.trim().equalsIgnoreCase(getDecodeModeName(candidate)))
         {
-            f0[t] = 0.0f;
+            mode = candidate;
+            return true;
         }
     }
+    return false;
+}
+
+uint64_t FCPEPitchDetector::getSettingsHash() const
+{
+    ContentHash hash;
+    hash.add(modelHash).add(chunkFrames).add(contextFrames).add(Resampler::designVersion).add(frameGridVersion);
+    hash.add(static_cast<int>(decodeMode)).add(skipSilence);
+    if (skipSilence)
+        hash.add(silenceThresholdDb);
+    return hash.getHash();
+}
+
+void FCPEPitchDetector::setChunkLength(float chunkSeconds, float contextSeconds)
+{
+    const float framesPerSecond = static_cast<float>(FCPE_SAMPLE_RATE) / HOP_SIZE;
+    chunkFrames = std::max(0, static_cast<int>(std::round(chunkSeconds * framesPerSecond)));
+    contextFrames = std::max(0, static_cast<int>(std::round(contextSeconds * framesPerSecond)));
+}
+
+void FCPEPitchDetector::setSkipSilence(bool shouldSkip, float thresholdDb)
+{
+    skipSilence = shouldSkip;
+    silenceThresholdDb = thresholdDb;
+}
+
+void FCPEPitchDetector::copySettingsFrom(const FCPEPitchDetector& other)
+{
+    chunkFrames = other.chunkFrames;
+    contextFrames = other.contextFrames;
+    skipSilence = other.skipSilence;
+    silenceThresholdDb = other.silenceThresholdDb;
+    decodeMode = other.decodeMode;
+}
+
+int64_t FCPEPitchDetector::estimateMemoryBytes(int numSamples, int sampleRate) const
+{
+    const int numFrames = getNumFrames(numSamples, sampleRate);
+    const int chunkFrameCount = (chunkFrames > 0 ? std::min(chunkFrames, numFrames) : numFrames) + 2 * contextFrames;
+    const int64_t samples16k = static_cast<int64_t>(numFrames) * HOP_SIZE;
+    
+    return static_cast<int64_t>(sizeof(float))
+         * (samples16k + static_cast<int64_t>(chunkFrameCount) * (N_MELS + OUT_DIMS) + numFrames);
+}
+
+std::vector<std::pair<int, int>> FCPEPitchDetector::getInferenceSpans(const float* audio16k, int numSamples16k,
+                                                                      int numFrames) const
+{
+    if (!skipSilence)
+        return { { 0, numFrames } };
+    
+    const auto activity = ActivityMap::compute(audio16k, numSamples16k, HOP_SIZE, WIN_SIZE,
+                                               numFrames, silenceThresholdDb);
     
-    return f0;
+    // A gap the two neighbouring contexts would cover anyway is cheaper to run
+    // as one span than to skip
+    const int minGapFrames = std::max(silenceMinGapFrames, 2 * contextFrames);
+    
+    DBG("FCPE: " << activity.getNumActiveFrames() << "/" << numFrames << " frames above the silence gate");
+    return activity.getActiveRanges(0, numFrames, silencePadFrames, minGapFrames);
+}
+
+std::vector<std::pair<int, int>> FCPEPitchDetector::splitIntoChunks(const std::vector<std::pair<int, int>>& spans) const
+{
+    std::vector<std::pair<int, int>> chunks;
+    for (const auto& [spanStart, spanEnd] : spans)
+    {
+        const int framesPerChunk = chunkFrames > 0 ? chunkFrames : std::max(1, spanEnd - spanStart);
+        for (int start = spanStart; start < spanEnd; start += framesPerChunk)
+            chunks.emplace_back(start, std::min(spanEnd, start + framesPerChunk));
+    }
+    return chunks;
+}
+
+int64_t FCPEPitchDetector::countInputFrames(const std::vector<std::pair<int, int>>& chunks, int numFrames) const
+{
+    int64_t total = 0;
+    for (const auto& [keepStart, keepEnd] : chunks)
+        total += std::min(numFrames, keepEnd + contextFrames) - std::max(0, keepStart - contextFrames);
+    return total;
+}
+
+std::vector<std::pair<int, int>> FCPEPitchDetector::planChunks(const float* audio16k, int numSamples16k,
+                                                               int numFrames) const
+{
+    const auto ungated = splitIntoChunks({ { 0, numFrames } });
+    if (!skipSilence)
+        return ungated;
+    
+    // Only spans with signal go through the model; silent frames stay unvoiced
+    auto gated = splitIntoChunks(getInferenceSpans(audio16k, numSamples16k, numFrames));
+    
+    // Span edges add chunks (and their context) the plain grid doesn't have;
+    // never run more frames than no gating would
+    const int64_t gatedFrames = countInputFrames(gated, numFrames);
+    const int64_t ungatedFrames = countInputFrames(ungated, numFrames);
+    
+    DBG("FCPE: " << gatedFrames << " frames inferred with the silence gate, " << ungatedFrames << " without");
+    if (gatedFrames > ungatedFrames)
+        return ungated;
+    
+    return gated;
 }
 
 std::vector<float> FCPEPitchDetector::extractF0(const float* audio, int numSamples,
-                                                  int sampleRate, float threshold)
+                                                  int sampleRate, float threshold,
+                                                  const ChunkProgressCallback& onChunkDone)
 {
 #ifdef HAVE_ONNXRUNTIME
     if (!loaded)
@@ -400,61 +626,71 @@ std::vector<float> FCPEPitchDetector::extractF0(const float* audio, int numSampl
     {
         // Step 1: Resample to 16kHz
         auto audio16k = resampleTo16k(audio, numSamples, sampleRate);
+        const int numSamples16k = static_cast<int>(audio16k.size());
         
-        // Step 2: Extract mel spectrogram
-        auto mel = extractMel(audio16k);
-        
-        if (mel.empty())
-        {
-            DBG("Empty mel spectrogram");
-            return {};
-        }
-        
-        // Step 3: Prepare input tensor [1, T, N_MELS]
-        int numFrames = static_cast<int>(mel.size());
-        std::vector<float> inputData(numFrames * N_MELS);
-        
-        for (int t = 0; t < numFrames; ++t)
-        {
-            for (int m = 0; m < N_MELS; ++m)
-            {
-                inputData[t * N_MELS + m] = mel[t][m];
-            }
-        }
-        
-        std::array<int64_t, 3> inputShape = {1, numFrames, N_MELS};
-        
-        Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
+        const int numFrames = melExtractor->getNumFrames(numSamples16k);
+        const auto chunks = planChunks(audio16k.data(), numSamples16k, numFrames);
         
-        Ort::Value inputTensor = Ort::Value::CreateTensor<float>(
-            memoryInfo, inputData.data(), inputData.size(),
-            inputShape.data(), inputShape.size());
+        const int numChunks = static_cast<int>(chunks.size());
         
-        // Step 4: Run inference
-        auto outputTensors = onnxSession->Run(
-            Ort::RunOptions{nullptr},
-            inputNames.data(), &inputTensor, 1,
-            outputNames.data(), 1);
+        std::vector<float> f0(numFrames, 0.0f);
+        auto& context = *inferenceContext;
         
-        // Step 5: Get output [1, T, OUT_DIMS]
-        float* outputData = outputTensors[0].GetTensorMutableData<float>();
-        auto outputShape = outputTensors[0].GetTensorTypeAndShapeInfo().GetShape();
-        
-        int outFrames = static_cast<int>(outputShape[1]);
-        
-        // Convert to 2D vector
-        std::vector<std::vector<float>> latent(outFrames);
-        for (int t = 0; t < outFrames; ++t)
+        for (int chunk = 0; chunk < numChunks; ++chunk)
         {
-            latent[t].resize(OUT_DIMS);
-            for (int d = 0; d < OUT_DIMS; ++d)
+            // Frames kept from this chunk, and the frames the model sees around them
+            const auto [keepStart, keepEnd] = chunks[static_cast<size_t>(chunk)];
+            const int inputStart = std::max(0, keepStart - contextFrames);
+            const int inputEnd = std::min(numFrames, keepEnd + contextFrames);
+            
+            // Step 2: Mel frames of the chunk (identical to the whole-file mel)
+            melExtractor->computeFrameRange(audio16k.data(), numSamples16k, inputStart, inputEnd, context.mel);
+            
+            if (context.mel.empty())
             {
-                latent[t][d] = outputData[t * OUT_DIMS + d];
+                DBG("Empty mel spectrogram");
+                return {};
             }
+            
+            // Step 3: Bind mel [1, T, N_MELS] and the output [1, T, OUT_DIMS], one
+            // latent frame per mel frame, over the reused buffers (no copies)
+            const int chunkFrameCount = context.mel.getNumFrames();
+            const size_t outputSize = static_cast<size_t>(chunkFrameCount) * OUT_DIMS;
+            if (context.output.size() < outputSize)
+                context.output.resize(outputSize);
+            
+            std::array<int64_t, 3> inputShape = {1, chunkFrameCount, N_MELS};
+            std::array<int64_t, 3> outputShape = {1, chunkFrameCount, OUT_DIMS};
+            
+            Ort::Value inputTensor = Ort::Value::CreateTensor<float>(
+                context.memoryInfo, context.mel.data(), context.mel.size(),
+                inputShape.data(), inputShape.size());
+            Ort::Value outputTensor = Ort::Value::CreateTensor<float>(
+                context.memoryInfo, context.output.data(), outputSize,
+                outputShape.data(), outputShape.size());
+            
+            context.binding.ClearBoundInputs();
+            context.binding.ClearBoundOutputs();
+            context.binding.BindInput(inputNames[0], inputTensor);
+            context.binding.BindOutput(outputNames[0], outputTensor);
+            
+            // Step 4: Run inference
+            onnxSession->Run(Ort::RunOptions{nullptr}, context.binding);
+            
+            // Step 5: Frames of the output kept from this chunk
+            const float* outputData = context.output.data();
+            const int keepOffset = keepStart - inputStart;
+            const int keepCount = std::max(0, std::min(keepEnd - keepStart, chunkFrameCount - keepOffset));
+            
+            // Step 6: Decode the kept frames straight from the output tensor into f0
+            decodeF0(outputData + static_cast<size_t>(keepOffset) * OUT_DIMS, keepCount,
+                     threshold, f0.data() + keepStart);
+            
+            if (onChunkDone)
+                onChunkDone(chunk + 1, numChunks);
         }
         
-        // Step 6: Decode to F0
-        return decodeF0(latent, threshold);
+        return f0;
     }
     catch (const Ort::Exception& e)
     {
@@ -467,22 +703,66 @@ std::vector<float> FCPEPitchDetector::extractF0(const float* audio, int numSampl
         return {};
     }
 #else
+    juce::ignoreUnused(audio, numSamples, sampleRate, threshold, onChunkDone);
     DBG("ONNX Runtime not available");
     return {};
 #endif
 }
 
+std::pair<std::vector<float>, std::vector<bool>>
+FCPEPitchDetector::detectF0(const float* audio, int numSamples, int sampleRate, int hopSize, int numFrames,
+                            const ProgressCallback& onProgress)
+{
+    const std::vector<float> fcpeF0 = extractF0(audio, numSamples, sampleRate, DEFAULT_THRESHOLD, onProgress);
+    const int numSource = static_cast<int>(fcpeF0.size());
+    if (numSource == 0)
+        return {};
+    
+    numFrames = std::max(0, numFrames);
+    std::vector<float> f0(static_cast<size_t>(numFrames), 0.0f);
+    std::vector<bool> voicedMask(static_cast<size_t>(numFrames), false);
+    
+    // FCPE frames (100 fps) per caller frame, e.g. 512 / 44100 s -> 1.161
+    const double ratio = static_cast<double>(hopSize) * FCPE_SAMPLE_RATE / (static_cast<double>(sampleRate) * HOP_SIZE);
+    
+    for (int i = 0; i < numFrames; ++i)
+    {
+        const double srcPos = i * ratio;
+        const int srcIdx = static_cast<int>(srcPos);
+        const double frac = srcPos - srcIdx;
+        
+        float value = 0.0f;
+        if (srcIdx + 1 < numSource)
+        {
+            // Linear interpolation, but only between voiced frames
+            const float a = fcpeF0[static_cast<size_t>(srcIdx)];
+            const float b = fcpeF0[static_cast<size_t>(srcIdx) + 1];
+            
+            if (a > 0.0f && b > 0.0f)
+                value = static_cast<float>(a * (1.0 - frac) + b * frac);
+            else if (a > 0.0f)
+                value = a;
+            else
+                value = b;
+        }
+        else if (srcIdx < numSource)
+        {
+            value = fcpeF0[static_cast<size_t>(srcIdx)];
+        }
+        
+        f0[static_cast<size_t>(i)] = value;
+        voicedMask[static_cast<size_t>(i)] = value > 0.0f;
+    }
+    
+    return { std::move(f0), std::move(voicedMask) };
+}
+
 int FCPEPitchDetector::getNumFrames(int numSamples, int sampleRate) const
 {
     // Convert to 16kHz sample count
     int samples16k = static_cast<int>(numSamples * static_cast<double>(FCPE_SAMPLE_RATE) / sampleRate);
     
-    // Calculate padding
-    int padLeft = (WIN_SIZE - HOP_SIZE) / 2;
-    int padRight = std::max((WIN_SIZE - HOP_SIZE + 1) / 2, WIN_SIZE - samples16k - padLeft);
-    
-    int paddedLen = samples16k + padLeft + padRight;
-    return 1 + (paddedLen - WIN_SIZE) / HOP_SIZE;
+    return melExtractor->getNumFrames(samples16k);
 }
 
 float FCPEPitchDetector::getTimeForFrame(int frameIndex) const
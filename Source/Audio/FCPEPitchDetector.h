@@ -1,9 +1,15 @@
 #pragma once
 
 #include "../JuceHeader.h"
+#include "F0Detector.h"
+#include "../Utils/ActivityMap.h"
+#include "../Utils/MelMatrix.h"
+#include "../Utils/MelSpectrogram.h"
 #include <vector>
 #include <array>
+#include <functional>
 #include <memory>
+#include <cstdint>
 
 #ifdef HAVE_ONNXRUNTIME
 #include <onnxruntime_cxx_api.h>
@@ -16,7 +22,7 @@
  * This implementation matches the PyTorch FCPE model's mel extraction
  * and post-processing to ensure consistent results.
  */
-class FCPEPitchDetector
+class FCPEPitchDetector : public F0Detector
 {
 public:
     // FCPE configuration constants
@@ -35,8 +41,35 @@ public:
     static constexpr float FMAX = 8000.0f;
     static constexpr float CLIP_VAL = 1e-5f;
     
+    // Confidence below which frames are unvoiced (extractF0 default, detectF0)
+    static constexpr float DEFAULT_THRESHOLD = 0.05f;
+    
+    // Chunked inference defaults (see setChunkLength)
+    static constexpr float DEFAULT_CHUNK_SECONDS = 60.0f;
+    static constexpr float DEFAULT_CHUNK_CONTEXT_SECONDS = 2.0f;
+    
+    /**
+     * How decodeF0 turns the 360 cent bins into a pitch track:
+     *  - LocalArgmax: per frame, weighted average around the strongest bin.
+     *  - Viterbi: most likely bin path under a limited-jump transition model,
+     *    then the same weighted average around the path. Removes most octave
+     *    jumps on breathy material at a few times the cost.
+     */
+    enum class DecodeMode
+    {
+        LocalArgmax,
+        Viterbi
+    };
+    
+    /** "argmax" / "viterbi" (config files). */
+    static const char* getDecodeModeName(DecodeMode mode);
+    static bool parseDecodeModeName(const juce::String& name, DecodeMode& mode);
+    
+    /** Called after each inference chunk with the number of chunks done so far. */
+    using ChunkProgressCallback = std::function<void(int chunksDone, int numChunks)>;
+    
     FCPEPitchDetector();
-    ~FCPEPitchDetector();
+    ~FCPEPitchDetector() override;
     
     /**
      * Load FCPE model from ONNX file.
@@ -54,18 +87,86 @@ public:
      */
     bool isLoaded() const { return loaded; }
     
+    // F0Detector
+    const char* getDetectorName() const override { return "fcpe"; }
+    bool isReady() const override { return loaded; }
+    
+    /**
+     * Hash of the loaded model, mel filterbank and cent table files
+     * (identifies this detector's output for analysis caching).
+     */
+    uint64_t getModelHash() const { return modelHash; }
+    
+    /**
+     * Hash of the model and every setting that affects extractF0
+     * (model files, chunking, silence gate, decoder and resampler).
+     */
+    uint64_t getSettingsHash() const override;
+    
+    /**
+     * Run the model over windows of chunkSeconds instead of the whole file, so
+     * memory and per-Run latency stay bounded on long recordings. Each window
+     * is extended by contextSeconds on both sides and only its centre is kept,
+     * so chunk boundaries never see the edge of the model's input.
+     * @param chunkSeconds Window length; 0 runs the whole file at once
+     */
+    void setChunkLength(float chunkSeconds, float contextSeconds = DEFAULT_CHUNK_CONTEXT_SECONDS);
+    float getChunkSeconds() const { return static_cast<float>(chunkFrames) * HOP_SIZE / FCPE_SAMPLE_RATE; }
+    
+    /**
+     * Skip inference on silent spans (energy gate, see ActivityMap); their
+     * frames come out unvoiced. Spans are padded and short gaps bridged, so
+     * the model still sees onsets and decays with context. On by default.
+     */
+    void setSkipSilence(bool shouldSkip, float thresholdDb = ActivityMap::defaultThresholdDb);
+    bool getSkipSilence() const { return skipSilence; }
+    
+    /**
+     * ONNX Runtime intra-op threads per session (default 1); takes effect at
+     * the next loadModel. Batch analysis trades these against the number of
+     * concurrent sessions.
+     */
+    void setIntraOpThreads(int numThreads) { intraOpThreads = numThreads > 1 ? numThreads : 1; }
+    int getIntraOpThreads() const { return intraOpThreads; }
+    
+    /**
+     * Take the chunking, silence gate and decoder settings of another
+     * detector, so with the same model both give the same results (and
+     * settings hash).
+     */
+    void copySettingsFrom(const FCPEPitchDetector& other);
+    
+    /**
+     * Peak working memory of extractF0 on numSamples at sampleRate: the
+     * 16 kHz copy, one chunk's mel and model output, and the F0 track.
+     * Excludes the session itself.
+     */
+    int64_t estimateMemoryBytes(int numSamples, int sampleRate) const;
+    
     /**
      * Extract F0 from audio buffer.
      * The audio will be resampled to 16kHz internally.
+     * Reuses this detector's inference buffers, so calls on one detector
+     * must not overlap.
      * 
      * @param audio Audio samples
      * @param numSamples Number of samples
      * @param sampleRate Original sample rate
      * @param threshold Confidence threshold (default 0.05)
+     * @param onChunkDone Optional progress callback, called once per chunk
      * @return F0 values in Hz (0 for unvoiced frames)
      */
     std::vector<float> extractF0(const float* audio, int numSamples, 
-                                  int sampleRate, float threshold = 0.05f);
+                                  int sampleRate, float threshold = DEFAULT_THRESHOLD,
+                                  const ChunkProgressCallback& onChunkDone = nullptr);
+    
+    /**
+     * extractF0 interpolated onto frames hopSize samples apart at sampleRate
+     * (by time, between voiced neighbours only), with onProgress per chunk.
+     */
+    std::pair<std::vector<float>, std::vector<bool>>
+    detectF0(const float* audio, int numSamples, int sampleRate, int hopSize, int numFrames,
+             const ProgressCallback& onProgress = nullptr) override;
     
     /**
      * Get the number of F0 frames that will be produced for given audio length.
@@ -82,23 +183,90 @@ public:
      */
     int getHopSizeForSampleRate(int sampleRate) const;
     
+    /**
+     * Mel spectrogram [T, N_MELS] of 16 kHz audio (frame-major, binds
+     * directly as model input). First stage of extractF0.
+     */
+    MelMatrix extractMel(const std::vector<float>& audio);
+    
+    void setDecodeMode(DecodeMode mode) { decodeMode = mode; }
+    DecodeMode getDecodeMode() const { return decodeMode; }
+    
+    /**
+     * Decode model output rows [numFrames][OUT_DIMS] (row-major; extractF0
+     * passes the ORT output tensor in place) to F0 in Hz with the current
+     * decode mode, writing numFrames values to f0. Last stage of extractF0.
+     */
+    void decodeF0(const float* latent, int numFrames, float threshold, float* f0) const;
+    
+    /** Decode and mel frame ranges on the shared WorkerPool (default on). */
+    void setMultithreaded(bool shouldUseWorkerPool);
+    
 private:
     bool loaded = false;
     
-    // Mel filterbank matrix [N_MELS x (N_FFT/2+1)]
-    std::vector<std::vector<float>> melFilterbank;
+    // Mel front-end on the shared STFT engine (symmetric Hann, reflect padding)
+    std::unique_ptr<MelSpectrogram> melExtractor;
+    uint64_t modelHash = 0;
+    
+    // Bumped when detectF0's mapping onto the caller's frames changes (cached results)
+    static constexpr int frameGridVersion = 1;
+    
+    // Chunked inference, in FCPE frames (0 = whole file)
+    int chunkFrames = static_cast<int>(DEFAULT_CHUNK_SECONDS * FCPE_SAMPLE_RATE / HOP_SIZE);
+    int contextFrames = static_cast<int>(DEFAULT_CHUNK_CONTEXT_SECONDS * FCPE_SAMPLE_RATE / HOP_SIZE);
+    
+    // Silence gate: spans are padded by silencePadFrames and gaps shorter
+    // than silenceMinGapFrames (or both contexts together) are run anyway
+    // (10 ms frames)
+    static constexpr int silencePadFrames = 10;
+    static constexpr int silenceMinGapFrames = 50;
+    bool skipSilence = true;
+    float silenceThresholdDb = ActivityMap::defaultThresholdDb;
     
-    // Hann window [WIN_SIZE]
-    std::vector<float> hannWindow;
+    std::vector<std::pair<int, int>> getInferenceSpans(const float* audio16k, int numSamples16k, int numFrames) const;
+    
+    // Kept frame ranges per inference chunk; falls back to the ungated grid
+    // whenever gating would feed the model more frames
+    std::vector<std::pair<int, int>> planChunks(const float* audio16k, int numSamples16k, int numFrames) const;
+    std::vector<std::pair<int, int>> splitIntoChunks(const std::vector<std::pair<int, int>>& spans) const;
+    int64_t countInputFrames(const std::vector<std::pair<int, int>>& chunks, int numFrames) const;
     
     // Cent table for decoding [OUT_DIMS]
     std::vector<float> centTable;
     
+    // Frames per decodeF0 task on the worker pool
+    static constexpr int framesPerDecodeBlock = 512;
+    bool multithreaded = true;
+    int intraOpThreads = 1;
+    
+    DecodeMode decodeMode = DecodeMode::LocalArgmax;
+    
+    // Viterbi: jumps of up to viterbiBand bins per frame (~220 cents), decoded
+    // in independent windows of viterbiChunkFrames plus viterbiContextFrames
+    // on each side
+    static constexpr int viterbiBand = 11;
+    static constexpr int viterbiChunkFrames = 1024;
+    static constexpr int viterbiContextFrames = 64;
+    
+    struct ViterbiScratch;
+    
+    void decodeFrames(const float* latent, int startFrame, int endFrame, float threshold, float* f0) const;
+    void decodeViterbi(const float* latent, int numFrames, float threshold, float* f0) const;
+    void decodeViterbiChunk(const float* latent, int numFrames, int keepStart, int keepEnd,
+                            float threshold, float* f0, ViterbiScratch& scratch) const;
+    float decodeAroundBin(const float* frame, int centreBin) const;
+    
+    // Chunk input / output buffers bound to the session, kept across extractF0 calls
+    struct InferenceContext;
+    std::unique_ptr<InferenceContext> inferenceContext;
+    
     // Initialize mel filterbank (Slaney normalization to match librosa)
     void initMelFilterbank();
     
-    // Initialize Hann window
-    void initHannWindow();
+    // STFT framing used by FCPE training
+    static STFT::Config getSTFTConfig();
+    void setMelFilterbank(MelFilterbank filterbank);
     
     // Initialize cent table
     void initCentTable();
@@ -106,13 +274,6 @@ private:
     // Resample audio to 16kHz
     std::vector<float> resampleTo16k(const float* audio, int numSamples, int srcRate);
     
-    // Extract mel spectrogram
-    std::vector<std::vector<float>> extractMel(const std::vector<float>& audio);
-    
-    // Decode latent to F0 (local argmax decoder)
-    std::vector<float> decodeF0(const std::vector<std::vector<float>>& latent, 
-                                 float threshold);
-    
     // Convert cent to F0
     static float centToF0(float cent) {
         return 10.0f * std::pow(2.0f, cent / 1200.0f);
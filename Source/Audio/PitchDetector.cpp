@@ -1,4 +1,6 @@
 #include "PitchDetector.h"
+#include "../Utils/ContentHash.h"
+#include "../Utils/WorkerPool.h"
 #include <cmath>
 #include <algorithm>
 
@@ -8,6 +10,16 @@ PitchDetector::PitchDetector(int sampleRate, int hopSize)
     windowSize = std::max(2048, static_cast<int>(sampleRate / f0Min) * 2);
 }
 
+uint64_t PitchDetector::getSettingsHash() const
+{
+    ContentHash hash;
+    hash.add(sampleRate).add(hopSize).add(f0Min).add(f0Max).add(threshold).add(windowSize);
+    hash.add(static_cast<int>(differenceMethod));
+    if (differenceMethod == DifferenceMethod::Fft)
+        hash.add(static_cast<int>(FFTBackend::getDefaultType()));
+    return hash.getHash();
+}
+
 std::pair<std::vector<float>, std::vector<bool>> 
 PitchDetector::extractF0(const float* audio, int numSamples)
 {
@@ -19,58 +31,119 @@ PitchDetector::extractF0(const float* audio, int numSamples)
     }
     
     std::vector<float> f0Values(numFrames, 0.0f);
-    std::vector<bool> voicedMask(numFrames, false);
+    const int numBlocks = (numFrames + framesPerBlock - 1) / framesPerBlock;
+    
+    if (!multithreaded || numBlocks <= 1)
+    {
+        Scratch scratch;
+        prepareScratch(scratch);
+        detectFrames(audio, numSamples, 0, numFrames, f0Values.data(), scratch);
+    }
+    else
+    {
+        // Frames are independent and each block writes its own slice of f0Values
+        auto& pool = WorkerPool::getInstance();
+        std::vector<Scratch> scratch(static_cast<size_t>(pool.getMaxConcurrency()));
+        
+        pool.parallelFor(numBlocks, [&](int block, int worker)
+        {
+            auto& workerScratch = scratch[static_cast<size_t>(worker)];
+            if (workerScratch.d.empty())
+                prepareScratch(workerScratch);
+            
+            const int start = block * framesPerBlock;
+            const int end = std::min(numFrames, start + framesPerBlock);
+            detectFrames(audio, numSamples, start, end, f0Values.data(), workerScratch);
+        });
+    }
     
+    // Unvoiced frames were left at 0 (std::vector<bool> can't be written concurrently)
+    std::vector<bool> voicedMask(numFrames, false);
     for (int i = 0; i < numFrames; ++i)
+        voicedMask[i] = f0Values[i] > 0.0f;
+    
+    return { f0Values, voicedMask };
+}
+
+std::pair<std::vector<float>, std::vector<bool>>
+PitchDetector::detectF0(const float* audio, int numSamples, int rate, int hop, int numFrames,
+                        const ProgressCallback& onProgress)
+{
+    if (rate != sampleRate)
+    {
+        sampleRate = rate;
+        windowSize = std::max(2048, static_cast<int>(sampleRate / f0Min) * 2);
+    }
+    hopSize = hop;
+    
+    auto [f0Values, voicedMask] = extractF0(audio, numSamples);
+    f0Values.resize(static_cast<size_t>(std::max(0, numFrames)), 0.0f);
+    voicedMask.resize(static_cast<size_t>(std::max(0, numFrames)), false);
+    
+    if (onProgress)
+        onProgress(1, 1);
+    
+    return { std::move(f0Values), std::move(voicedMask) };
+}
+
+void PitchDetector::prepareScratch(Scratch& scratch) const
+{
+    // The largest frame is windowSize samples, i.e. lags [0, windowSize / 2)
+    const int halfSize = std::max(2, windowSize / 2);
+    
+    int order = 1;
+    while ((1 << order) < 2 * halfSize)
+        ++order;
+    const size_t fftSize = static_cast<size_t>(1) << order;
+    
+    if (differenceMethod == DifferenceMethod::Fft)
+    {
+        scratch.fft = FFTBackend::create(order);
+        scratch.frameSpectrum.assign(fftSize * 2, 0.0f);
+        scratch.lagSpectrum.assign(fftSize * 2, 0.0f);
+        scratch.energyPrefix.assign(static_cast<size_t>(2 * halfSize) + 1, 0.0);
+    }
+    
+    scratch.d.assign(static_cast<size_t>(halfSize), 0.0f);
+    scratch.dPrime.assign(static_cast<size_t>(halfSize), 0.0f);
+}
+
+void PitchDetector::detectFrames(const float* audio, int numSamples, int startFrame, int endFrame,
+                                 float* f0Values, Scratch& scratch) const
+{
+    for (int i = startFrame; i < endFrame; ++i)
     {
         int startSample = i * hopSize;
         int availableSamples = numSamples - startSample;
         int frameSamples = std::min(windowSize, availableSamples);
         
+        f0Values[i] = 0.0f;
+        
         if (frameSamples < 512)  // Too short for pitch detection
-        {
-            f0Values[i] = 0.0f;
-            voicedMask[i] = false;
             continue;
-        }
         
-        float pitch = yinPitchDetect(audio + startSample, frameSamples);
+        float pitch = yinPitchDetect(audio + startSample, frameSamples, scratch);
         
         if (pitch > 0.0f && pitch >= f0Min && pitch <= f0Max)
-        {
             f0Values[i] = pitch;
-            voicedMask[i] = true;
-        }
-        else
-        {
-            f0Values[i] = 0.0f;
-            voicedMask[i] = false;
-        }
     }
-    
-    return { f0Values, voicedMask };
 }
 
-float PitchDetector::yinPitchDetect(const float* buffer, int bufferSize)
+float PitchDetector::yinPitchDetect(const float* buffer, int bufferSize, Scratch& scratch) const
 {
     int halfSize = bufferSize / 2;
     if (halfSize < 2) return -1.0f;
     
-    std::vector<float> d(halfSize);
+    float* d = scratch.d.data();
     
     // Step 2: Difference function
-    for (int tau = 0; tau < halfSize; ++tau)
-    {
-        d[tau] = 0.0f;
-        for (int j = 0; j < halfSize; ++j)
-        {
-            float diff = buffer[j] - buffer[j + tau];
-            d[tau] += diff * diff;
-        }
-    }
+    if (differenceMethod == DifferenceMethod::Direct)
+        differenceDirect(buffer, halfSize, d);
+    else
+        differenceFft(buffer, bufferSize, halfSize, d, scratch);
     
     // Step 3: Cumulative mean normalized difference function
-    std::vector<float> dPrime(halfSize);
+    float* dPrime = scratch.dPrime.data();
     dPrime[0] = 1.0f;
     float runningSum = 0.0f;
     
@@ -100,7 +173,7 @@ float PitchDetector::yinPitchDetect(const float* buffer, int bufferSize)
         return -1.0f;  // No pitch found
     
     // Step 5: Parabolic interpolation
-    float betterTau = parabolicInterpolation(dPrime, tau);
+    float betterTau = parabolicInterpolation(dPrime, halfSize, tau);
     
     if (betterTau > 0.0f)
         return static_cast<float>(sampleRate) / betterTau;
@@ -108,9 +181,77 @@ float PitchDetector::yinPitchDetect(const float* buffer, int bufferSize)
     return -1.0f;
 }
 
-float PitchDetector::parabolicInterpolation(const std::vector<float>& d, int tau)
+void PitchDetector::differenceDirect(const float* buffer, int halfSize, float* d) const
+{
+    for (int tau = 0; tau < halfSize; ++tau)
+    {
+        d[tau] = 0.0f;
+        for (int j = 0; j < halfSize; ++j)
+        {
+            float diff = buffer[j] - buffer[j + tau];
+            d[tau] += diff * diff;
+        }
+    }
+}
+
+void PitchDetector::differenceFft(const float* buffer, int bufferSize, int halfSize, float* d,
+                                  Scratch& scratch) const
+{
+    // d(tau) = sum_j (x[j] - x[j + tau])^2 over j < halfSize
+    //        = e(0) + e(tau) - 2 r(tau)
+    // with e(tau) the energy of x[tau, tau + halfSize) and r the cross-correlation
+    // of the first halfSize samples with the whole buffer. Lags stay below
+    // halfSize, so a transform of 2 * halfSize samples has no wrap-around.
+    // Frames shorter than windowSize reuse the full-size transform, zero-padded.
+    auto& fft = *scratch.fft;
+    const int fftSize = fft.getSize();
+    jassert(fftSize >= 2 * halfSize);
+    
+    auto& frameSpectrum = scratch.frameSpectrum;
+    auto& lagSpectrum = scratch.lagSpectrum;
+    auto& energyPrefix = scratch.energyPrefix;
+    
+    const int lagLength = std::min(bufferSize, 2 * halfSize);
+    
+    std::fill(frameSpectrum.begin(), frameSpectrum.end(), 0.0f);
+    std::fill(lagSpectrum.begin(), lagSpectrum.end(), 0.0f);
+    std::copy(buffer, buffer + halfSize, frameSpectrum.begin());
+    std::copy(buffer, buffer + lagLength, lagSpectrum.begin());
+    
+    fft.performRealOnlyForwardTransform(frameSpectrum.data());
+    fft.performRealOnlyForwardTransform(lagSpectrum.data());
+    
+    // conj(X) * Y gives the correlation sum_j x[j] y[j + tau]
+    for (int k = 0; k <= fftSize / 2; ++k)
+    {
+        const float xr = frameSpectrum[2 * k], xi = frameSpectrum[2 * k + 1];
+        const float yr = lagSpectrum[2 * k], yi = lagSpectrum[2 * k + 1];
+        lagSpectrum[2 * k] = xr * yr + xi * yi;
+        lagSpectrum[2 * k + 1] = xr * yi - xi * yr;
+    }
+    
+    fft.performRealOnlyInverseTransform(lagSpectrum.data());
+    const float* correlation = lagSpectrum.data();
+    
+    // Energies in double: they are large next to d near the period
+    energyPrefix[0] = 0.0;
+    for (int i = 0; i < lagLength; ++i)
+        energyPrefix[i + 1] = energyPrefix[i] + static_cast<double>(buffer[i]) * buffer[i];
+    
+    const double energy0 = energyPrefix[halfSize];
+    
+    d[0] = 0.0f;
+    for (int tau = 1; tau < halfSize; ++tau)
+    {
+        const double energyTau = energyPrefix[tau + halfSize] - energyPrefix[tau];
+        const double value = energy0 + energyTau - 2.0 * correlation[tau];
+        d[tau] = static_cast<float>(std::max(0.0, value));
+    }
+}
+
+float PitchDetector::parabolicInterpolation(const float* d, int size, int tau)
 {
-    if (tau < 1 || tau >= static_cast<int>(d.size()) - 1)
+    if (tau < 1 || tau >= size - 1)
         return static_cast<float>(tau);
     
     float s0 = d[tau - 1];
@@ -1,17 +1,28 @@
 #pragma once
 
 #include "../JuceHeader.h"
+#include "F0Detector.h"
+#include "../Utils/FFTBackend.h"
 #include <vector>
+#include <memory>
+#include <cstdint>
 
 /**
  * Pitch detector using YIN algorithm.
  * (For production, you'd want to integrate a proper pitch detection library)
  */
-class PitchDetector
+class PitchDetector : public F0Detector
 {
 public:
+    /** How the YIN difference function is evaluated. */
+    enum class DifferenceMethod
+    {
+        Fft,    // Energies from prefix sums + FFT cross-correlation, O(N log N) per frame
+        Direct  // Reference double loop, O(N^2) per frame
+    };
+    
     PitchDetector(int sampleRate = 44100, int hopSize = 512);
-    ~PitchDetector() = default;
+    ~PitchDetector() override = default;
     
     /**
      * Extract F0 from audio buffer.
@@ -22,13 +33,53 @@ public:
     std::pair<std::vector<float>, std::vector<bool>> 
     extractF0(const float* audio, int numSamples);
     
+    // F0Detector
+    const char* getDetectorName() const override { return "yin"; }
+    bool isReady() const override { return true; }
+    
+    /**
+     * extractF0 at the given rate and hop (adopted as this detector's
+     * settings), padded with unvoiced frames or cut to numFrames.
+     */
+    std::pair<std::vector<float>, std::vector<bool>>
+    detectF0(const float* audio, int numSamples, int sampleRate, int hopSize, int numFrames,
+             const ProgressCallback& onProgress = nullptr) override;
+    
     void setSampleRate(int sr) { sampleRate = sr; }
     void setHopSize(int hop) { hopSize = hop; }
     void setF0Range(float min, float max) { f0Min = min; f0Max = max; }
+    void setDifferenceMethod(DifferenceMethod method) { differenceMethod = method; }
+    DifferenceMethod getDifferenceMethod() const { return differenceMethod; }
+    
+    /** Spread frames over the shared WorkerPool (default on; results are identical either way). */
+    void setMultithreaded(bool shouldUseWorkerPool) { multithreaded = shouldUseWorkerPool; }
+    
+    /**
+     * Hash of every parameter that affects extractF0 (for analysis caching).
+     */
+    uint64_t getSettingsHash() const override;
     
 private:
-    float yinPitchDetect(const float* buffer, int bufferSize);
-    float parabolicInterpolation(const std::vector<float>& d, int tau);
+    static constexpr int framesPerBlock = 32;
+    
+    // Per-thread buffers, sized once per extractF0 call so frames never allocate
+    struct Scratch
+    {
+        std::unique_ptr<FFTBackend> fft;
+        std::vector<float> frameSpectrum;
+        std::vector<float> lagSpectrum;
+        std::vector<double> energyPrefix;
+        std::vector<float> d;
+        std::vector<float> dPrime;
+    };
+    
+    void prepareScratch(Scratch& scratch) const;
+    void detectFrames(const float* audio, int numSamples, int startFrame, int endFrame,
+                      float* f0Values, Scratch& scratch) const;
+    float yinPitchDetect(const float* buffer, int bufferSize, Scratch& scratch) const;
+    void differenceDirect(const float* buffer, int halfSize, float* d) const;
+    void differenceFft(const float* buffer, int bufferSize, int halfSize, float* d, Scratch& scratch) const;
+    static float parabolicInterpolation(const float* d, int size, int tau);
     
     int sampleRate;
     int hopSize;
@@ -37,4 +88,6 @@ private:
     float threshold = 0.1f;  // YIN threshold
     
     int windowSize = 2048;
+    DifferenceMethod differenceMethod = DifferenceMethod::Fft;
+    bool multithreaded = true;
 };
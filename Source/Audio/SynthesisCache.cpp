@@ -0,0 +1,109 @@
+#include "SynthesisCache.h"
+#include "../Utils/ContentHash.h"
+
+namespace
+{
+    // Bump when the meaning of a cached render changes
+    constexpr uint32_t keyVersion = 1;
+}
+
+SynthesisCache::SynthesisCache(size_t maxBytes)
+    : maxBytes(maxBytes)
+{
+}
+
+uint64_t SynthesisCache::makeKey(const MelMatrix& mel, const std::vector<float>& f0,
+                                 const std::vector<std::pair<int, int>>& spans,
+                                 int chunkFrames, uint64_t settingsHash)
+{
+    ContentHash hash;
+    hash.add(keyVersion).add(settingsHash).add(chunkFrames);
+
+    hash.add(mel.getNumFrames()).add(mel.getNumMels()).add(static_cast<int>(mel.getLayout()));
+    hash.update(mel.data(), sizeof(float) * static_cast<size_t>(mel.getNumFrames()) * mel.getNumMels());
+
+    hash.add(f0.size());
+    hash.update(f0.data(), sizeof(float) * f0.size());
+
+    hash.add(spans.size());
+    for (const auto& [start, end] : spans)
+        hash.add(start).add(end);
+
+    return hash.getHash();
+}
+
+SynthesisCache::Render SynthesisCache::find(uint64_t key)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = index.find(key);
+    if (it == index.end())
+    {
+        ++numMisses;
+        return nullptr;
+    }
+
+    entries.splice(entries.begin(), entries, it->second);
+    ++numHits;
+    return it->second->samples;
+}
+
+void SynthesisCache::store(uint64_t key, Render render)
+{
+    const size_t bytes = render != nullptr ? render->size() * sizeof(float) : 0;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (bytes == 0 || bytes > maxBytes)
+        return;
+
+    auto it = index.find(key);
+    if (it != index.end())
+    {
+        sizeBytes -= getEntryBytes(*it->second);
+        entries.erase(it->second);
+        index.erase(it);
+    }
+
+    entries.push_front({ key, std::move(render) });
+    index[key] = entries.begin();
+    sizeBytes += bytes;
+
+    trimToSize();
+}
+
+void SynthesisCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+    sizeBytes = 0;
+}
+
+void SynthesisCache::setMaxBytes(size_t newMaxBytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    maxBytes = newMaxBytes;
+    trimToSize();
+}
+
+size_t SynthesisCache::getMaxBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return maxBytes;
+}
+
+size_t SynthesisCache::getSizeBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return sizeBytes;
+}
+
+void SynthesisCache::trimToSize()
+{
+    while (sizeBytes > maxBytes && !entries.empty())
+    {
+        sizeBytes -= getEntryBytes(entries.back());
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
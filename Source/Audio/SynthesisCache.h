@@ -0,0 +1,81 @@
+#pragma once
+
+#include "../Utils/MelMatrix.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * In-memory LRU cache of vocoder output, keyed by the content of the inputs.
+ *
+ * The key hashes the mel frames and the adjusted F0 the segment was rendered
+ * from, the spans synthesized, and the model and settings (see makeKey), so
+ * toggling an edit with undo/redo or dragging a note back to where it was
+ * finds the earlier render instead of running the model again. Entries are
+ * shared, never modified; the least recently used ones are evicted to stay
+ * within the memory budget.
+ *
+ * Thread-safe: the message thread looks results up while the synthesis
+ * worker stores them.
+ */
+class SynthesisCache
+{
+public:
+    static constexpr size_t defaultMaxBytes = 256 * 1024 * 1024;
+
+    /** A finished render, shared with whoever it was delivered to. */
+    using Render = std::shared_ptr<const std::vector<float>>;
+
+    explicit SynthesisCache(size_t maxBytes = defaultMaxBytes);
+
+    /**
+     * Key of rendering mel / f0 over the given spans.
+     * @param chunkFrames Window size if rendered with Vocoder::inferChunked, else 0
+     * @param settingsHash Model and session settings (Vocoder)
+     */
+    static uint64_t makeKey(const MelMatrix& mel, const std::vector<float>& f0,
+                            const std::vector<std::pair<int, int>>& spans,
+                            int chunkFrames, uint64_t settingsHash);
+
+    /** The stored render for key (now the most recently used), or nullptr. */
+    Render find(uint64_t key);
+
+    /** Store render for key, evicting old entries; larger than the budget is not stored. */
+    void store(uint64_t key, Render render);
+
+    void clear();
+
+    void setMaxBytes(size_t newMaxBytes);
+    size_t getMaxBytes() const;
+    size_t getSizeBytes() const;
+
+    int getNumHits() const { return numHits.load(); }
+    int getNumMisses() const { return numMisses.load(); }
+
+private:
+    struct Entry
+    {
+        uint64_t key = 0;
+        Render samples;
+    };
+
+    static size_t getEntryBytes(const Entry& entry) { return entry.samples->size() * sizeof(float); }
+
+    /** Evict from the back until the cache fits; mutex must be held. */
+    void trimToSize();
+
+    mutable std::mutex mutex;
+    std::list<Entry> entries;                                        // Most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+    size_t maxBytes;
+    size_t sizeBytes = 0;
+
+    std::atomic<int> numHits { 0 };
+    std::atomic<int> numMisses { 0 };
+};
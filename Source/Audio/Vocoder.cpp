@@ -1,73 +1,82 @@
 #include "Vocoder.h"
 #include "../Utils/Constants.h"
+#include "../Utils/ContentHash.h"
 #include <cmath>
 #include <thread>
 #include <algorithm>
 #include <chrono>
-#include <sstream>
-#include <iomanip>
+#include <array>
+
+/**
+ * Model input and output buffers, grown to the largest window seen and
+ * re-bound in place on every run, so repeated renders don't reallocate them.
+ */
+struct Vocoder::InferenceContext
+{
+#ifdef HAVE_ONNXRUNTIME
+    Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    std::unique_ptr<Ort::IoBinding> binding;    // For the current session
+    Ort::Value allocatedOutput { nullptr };     // Output when ONNX Runtime has to allocate it
+    bool bindOutputBuffer = true;               // False once the model's output shape disagrees
+#endif
+    
+    std::vector<float> melInput;                // [numMels, T] when mel can't be bound in place
+    std::vector<float> output;                  // Bound model output, or the sine fallback
+};
 
 Vocoder::Vocoder()
 {
-    // Open log file in executable directory
+    // Log file in executable directory, written by a background thread
     auto exePath = juce::File::getSpecialLocation(juce::File::currentExecutableFile);
     auto logPath = exePath.getParentDirectory().getChildFile("vocoder_log.txt");
-    logFile = std::make_unique<std::ofstream>(logPath.getFullPathName().toStdString(), std::ios::app);
+    logger = std::make_unique<AsyncLogger>(logPath, "Vocoder");
     
-    if (logFile && logFile->is_open())
-    {
-        auto now = std::chrono::system_clock::now();
-        auto time = std::chrono::system_clock::to_time_t(now);
-        *logFile << "\n========== Vocoder Session Started at " << std::ctime(&time) << " ==========\n";
-        logFile->flush();
-    }
+    inferenceContext = std::make_unique<InferenceContext>();
     
 #ifdef HAVE_ONNXRUNTIME
     // Initialize ONNX Runtime environment
     try {
         onnxEnv = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "PitchEditor");
         allocator = std::make_unique<Ort::AllocatorWithDefaultOptions>();
-        log("ONNX Runtime initialized successfully");
+        log(LogLevel::Info, "ONNX Runtime initialized successfully");
     } catch (const Ort::Exception& e) {
-        log("Failed to initialize ONNX Runtime: " + std::string(e.what()));
+        log(LogLevel::Error, "Failed to initialize ONNX Runtime: " + std::string(e.what()));
     }
 #endif
 }
 
 Vocoder::~Vocoder()
 {
+    cancelAll();
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopWorker = true;
+    }
+    jobsChanged.notify_all();
+    if (worker.joinable())
+        worker.join();
+    
 #ifdef HAVE_ONNXRUNTIME
+    inferenceContext.reset();
     onnxSession.reset();
     onnxEnv.reset();
 #endif
-    if (logFile && logFile->is_open())
-    {
-        log("Vocoder session ended");
-        logFile->close();
-    }
+    log(LogLevel::Info, "Vocoder session ended");
 }
 
-void Vocoder::log(const std::string& message)
+void Vocoder::log(LogLevel level, const std::string& message)
 {
-    DBG(message);
-    if (logFile && logFile->is_open())
-    {
-        auto now = std::chrono::system_clock::now();
-        auto time = std::chrono::system_clock::to_time_t(now);
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
-        
-        std::tm tm_buf;
-#ifdef _WIN32
-        localtime_s(&tm_buf, &time);
-#else
-        localtime_r(&time, &tm_buf);
-#endif
-        
-        *logFile << std::put_time(&tm_buf, "%H:%M:%S") << "." 
-                 << std::setfill('0') << std::setw(3) << ms.count() 
-                 << " | " << message << "\n";
-        logFile->flush();
-    }
+    logger->log(level, message);
+}
+
+void Vocoder::setLogLevel(LogLevel level)
+{
+    logger->setLevel(level);
+}
+
+Vocoder::LogLevel Vocoder::getLogLevel() const
+{
+    return logger->getLevel();
 }
 
 bool Vocoder::isOnnxRuntimeAvailable()
@@ -84,17 +93,25 @@ bool Vocoder::loadModel(const juce::File& modelPath)
 #ifdef HAVE_ONNXRUNTIME
     if (!onnxEnv)
     {
-        log("ONNX Runtime not initialized");
+        log(LogLevel::Error, "ONNX Runtime not initialized");
         return false;
     }
     
     if (!modelPath.existsAsFile())
     {
-        log("Vocoder: Model file not found: " + modelPath.getFullPathName().toStdString());
+        log(LogLevel::Error, "Vocoder: Model file not found: " + modelPath.getFullPathName().toStdString());
         return false;
     }
     
+    // No inference may run on the session being replaced
+    std::lock_guard<std::mutex> lock(inferenceMutex);
+    
     try {
+        // The old binding refers to the session being replaced
+        inferenceContext->binding.reset();
+        inferenceContext->allocatedOutput = Ort::Value(nullptr);
+        inferenceContext->bindOutputBuffer = true;
+        
         // Create session with current settings
         Ort::SessionOptions sessionOptions = createSessionOptions();
         
@@ -137,16 +154,24 @@ bool Vocoder::loadModel(const juce::File& modelPath)
             outputNames.push_back(name.c_str());
         }
         
-        log("Vocoder: ONNX model loaded successfully");
-        log("  Input names: " + std::string(inputNames.size() > 0 ? inputNames[0] : "none"));
-        log("  Output names: " + std::string(outputNames.size() > 0 ? outputNames[0] : "none"));
+        // Waveform output rank, so the output can be bound to our own buffer
+        outputRank = 0;
+        if (numOutputs > 0)
+            outputRank = static_cast<int>(onnxSession->GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape().size());
+        
+        inferenceContext->binding = std::make_unique<Ort::IoBinding>(*onnxSession);
+        
+        log(LogLevel::Info, "Vocoder: ONNX model loaded successfully");
+        log(LogLevel::Info, "  Input names: " + std::string(inputNames.size() > 0 ? inputNames[0] : "none"));
+        log(LogLevel::Info, "  Output names: " + std::string(outputNames.size() > 0 ? outputNames[0] : "none"));
         
         modelFile = modelPath;
+        updateSettingsHash(modelPath);
         loaded = true;
         return true;
         
     } catch (const Ort::Exception& e) {
-        log("Failed to load ONNX model: " + std::string(e.what()));
+        log(LogLevel::Error, "Failed to load ONNX model: " + std::string(e.what()));
         loaded = false;
         return false;
     }
@@ -171,186 +196,541 @@ bool Vocoder::loadModel(const juce::File& modelPath)
         }
     }
     
-    log("Vocoder: ONNX Runtime not available, using sine fallback");
+    log(LogLevel::Warning, "Vocoder: ONNX Runtime not available, using sine fallback");
+    updateSettingsHash(modelPath);
     loaded = true;  // Allow "loaded" state for fallback
     return true;
 #endif
 }
 
-std::vector<float> Vocoder::infer(const std::vector<std::vector<float>>& mel,
+void Vocoder::updateSettingsHash(const juce::File& model)
+{
+    ContentHash hash;
+    hash.add(isOnnxRuntimeAvailable()).add(sampleRate).add(hopSize).add(numMels);
+    
+    const auto path = model.getFullPathName().toStdString();
+    hash.update(path.data(), path.size());
+    hash.add(static_cast<int64_t>(model.getSize()));
+    hash.add(static_cast<int64_t>(model.getLastModificationTime().toMilliseconds()));
+    
+    // Execution providers may round differently
+    const auto device = executionDevice.toStdString();
+    hash.update(device.data(), device.size());
+    
+    settingsHash = hash.getHash();
+}
+
+std::vector<float> Vocoder::infer(const MelMatrix& mel,
                                    const std::vector<float>& f0)
 {
+    std::lock_guard<std::mutex> lock(inferenceMutex);
+    bool fromModel = false;
+    return inferImpl(mel, f0, nullptr, fromModel);
+}
+
+std::vector<float> Vocoder::inferSpans(const MelMatrix& mel,
+                                       const std::vector<float>& f0,
+                                       const std::vector<std::pair<int, int>>& spans)
+{
+    std::lock_guard<std::mutex> lock(inferenceMutex);
+    bool fromModel = false;
+    return inferSpansImpl(mel, f0, spans, nullptr, fromModel);
+}
+
+std::vector<float> Vocoder::inferChunked(const MelMatrix& mel,
+                                         const std::vector<float>& f0,
+                                         const std::vector<std::pair<int, int>>& spans,
+                                         const ChunkCallback& onChunk,
+                                         int chunkFrames)
+{
+    std::lock_guard<std::mutex> lock(inferenceMutex);
+    bool fromModel = false;
+    return inferChunkedImpl(mel, f0, spans, onChunk, chunkFrames, nullptr, fromModel);
+}
+
+std::vector<float> Vocoder::inferImpl(const MelMatrix& mel, const std::vector<float>& f0, RunControl* control,
+                                      bool& fromModel)
+{
+    auto startTotal = std::chrono::high_resolution_clock::now();
+    
+    const int numFrames = static_cast<int>(std::min(static_cast<size_t>(mel.getNumFrames()), f0.size()));
+    int numSamples = 0;
+    const float* output = runModel(mel, f0, 0, numFrames, numSamples, fromModel, control);
+    if (output == nullptr)
+        return {};
+    
+    std::vector<float> waveform(static_cast<size_t>(numSamples));
+    
+    if (fromModel)
+    {
+        // Gain and clamp on the way out of the output buffer
+        applyOutputGain(output, waveform.data(), numSamples);
+        
+        auto endTotal = std::chrono::high_resolution_clock::now();
+        auto totalMs = std::chrono::duration_cast<std::chrono::milliseconds>(endTotal - startTotal).count();
+        log(LogLevel::Debug, "Total vocoder inference took " + std::to_string(totalMs) + " ms");
+    }
+    else
+    {
+        juce::FloatVectorOperations::copy(waveform.data(), output, numSamples);
+    }
+    
+    return waveform;
+}
+
+std::vector<float> Vocoder::inferSpansImpl(const MelMatrix& mel,
+                                           const std::vector<float>& f0,
+                                           const std::vector<std::pair<int, int>>& spans,
+                                           RunControl* control,
+                                           bool& allFromModel)
+{
+    allFromModel = false;
     if (!loaded || mel.empty() || f0.empty())
         return {};
     
-    size_t numFrames = std::min(mel.size(), f0.size());
+    const int numFrames = static_cast<int>(std::min(static_cast<size_t>(mel.getNumFrames()), f0.size()));
     
-    log("Starting inference with " + std::to_string(numFrames) + " frames");
+    // One span over everything is a plain infer()
+    if (spans.size() == 1 && spans.front().first <= 0 && spans.front().second >= numFrames)
+        return inferImpl(mel, f0, control, allFromModel);
     
     auto startTotal = std::chrono::high_resolution_clock::now();
     
-#ifdef HAVE_ONNXRUNTIME
-    if (!onnxSession)
-    {
-        log("ONNX session not available, using fallback");
-        return generateSineFallback(f0);
-    }
+    std::vector<float> waveform(static_cast<size_t>(numFrames) * hopSize, 0.0f);
+    allFromModel = true;
+    int synthesizedFrames = 0;
     
-    try {
-        auto startPrep = std::chrono::high_resolution_clock::now();
+    for (const auto& [spanStart, spanEnd] : spans)
+    {
+        const int start = std::max(0, spanStart);
+        const int end = std::min(numFrames, spanEnd);
+        if (start >= end)
+            continue;
         
-        // Prepare mel input: [batch=1, num_mels, frames]
-        std::vector<int64_t> melShape = {1, static_cast<int64_t>(numMels), static_cast<int64_t>(numFrames)};
-        std::vector<float> melData(numMels * numFrames);
+        int numSamples = 0;
+        bool fromModel = false;
+        const float* spanAudio = runModel(mel, f0, start, end, numSamples, fromModel, control);
+        if (spanAudio == nullptr)
+            return {};
         
-        // Transpose mel from [T, num_mels] to [num_mels, T]
-        for (size_t frame = 0; frame < numFrames; ++frame)
-        {
-            for (int m = 0; m < numMels && m < static_cast<int>(mel[frame].size()); ++m)
-            {
-                melData[m * numFrames + frame] = mel[frame][m];
-            }
-        }
+        allFromModel = allFromModel && fromModel;
+        synthesizedFrames += end - start;
         
-        // Log mel statistics
-        float melMin = 99999.0f, melMax = -99999.0f;
-        for (float v : melData)
-        {
-            melMin = std::min(melMin, v);
-            melMax = std::max(melMax, v);
-        }
-        log("Mel stats: min=" + std::to_string(melMin) + " max=" + std::to_string(melMax));
+        const int offset = start * hopSize;
+        const int length = std::min(numSamples, static_cast<int>(waveform.size()) - offset);
+        juce::FloatVectorOperations::copy(waveform.data() + offset, spanAudio, length);
+    }
+    
+    // Short fades where a span meets skipped frames (spans are padded
+    // with silence, so this only removes residual clicks)
+    applySpanGain(waveform.data(), 0, static_cast<int>(waveform.size()), spans, numFrames);
+    
+    log(LogLevel::Debug, "Synthesized " + std::to_string(synthesizedFrames) + "/" + std::to_string(numFrames) +
+        " frames in " + std::to_string(spans.size()) + " spans");
+    
+    // The same fixed gain as infer()
+    if (allFromModel && synthesizedFrames > 0)
+        applyOutputGain(waveform.data(), waveform.data(), static_cast<int>(waveform.size()));
+    
+    auto endTotal = std::chrono::high_resolution_clock::now();
+    auto totalMs = std::chrono::duration_cast<std::chrono::milliseconds>(endTotal - startTotal).count();
+    log(LogLevel::Debug, "Total vocoder inference took " + std::to_string(totalMs) + " ms");
+    
+    return waveform;
+}
+
+std::vector<float> Vocoder::inferChunkedImpl(const MelMatrix& mel,
+                                             const std::vector<float>& f0,
+                                             const std::vector<std::pair<int, int>>& spans,
+                                             const ChunkCallback& onChunk,
+                                             int chunkFrames,
+                                             RunControl* control,
+                                             bool& allFromModel)
+{
+    allFromModel = false;
+    if (!loaded || mel.empty() || f0.empty())
+        return {};
+    
+    auto startTotal = std::chrono::high_resolution_clock::now();
+    
+    const int numFrames = static_cast<int>(std::min(static_cast<size_t>(mel.getNumFrames()), f0.size()));
+    const int totalSamples = numFrames * hopSize;
+    
+    // Windows at least as long as both crossfades
+    chunkFrames = std::max(chunkFrames, 2 * chunkOverlapFrames);
+    const int numChunks = (numFrames + chunkFrames - 1) / chunkFrames;
+    const int overlapSamples = chunkOverlapFrames * hopSize;
+    
+    auto isActive = [&spans](int startFrame, int endFrame)
+    {
+        if (spans.empty())
+            return true;
+        for (const auto& [spanStart, spanEnd] : spans)
+            if (spanStart < endFrame && spanEnd > startFrame)
+                return true;
+        return false;
+    };
+    
+    std::vector<float> waveform(static_cast<size_t>(totalSamples), 0.0f);
+    int deliveredSamples = 0;
+    int synthesizedChunks = 0;
+    allFromModel = true;
+    
+    for (int chunk = 0; chunk < numChunks; ++chunk)
+    {
+        if (control != nullptr && control->cancelled)
+            return {};
+        
+        const int coreStart = chunk * chunkFrames;
+        const int coreEnd = std::min(numFrames, coreStart + chunkFrames);
+        const bool isFirst = chunk == 0;
+        const bool isLast = chunk == numChunks - 1;
         
-        // Prepare f0 input: [batch=1, frames]
-        std::vector<int64_t> f0Shape = {1, static_cast<int64_t>(numFrames)};
-        std::vector<float> f0Data(f0.begin(), f0.begin() + numFrames);
+        // Frames this window writes (its core plus the crossfades)
+        const int outStart = isFirst ? 0 : coreStart - chunkOverlapFrames;
+        const int outEnd = isLast ? numFrames : std::min(numFrames, coreEnd + chunkOverlapFrames);
         
-        // Log F0 statistics
-        float f0Min = 99999.0f, f0Max = 0.0f, f0Sum = 0.0f;
-        int voicedCount = 0;
-        for (float freq : f0Data)
+        if (isActive(outStart, outEnd))
         {
-            if (freq > 0.0f)
+            const int inStart = std::max(0, coreStart - chunkContextFrames);
+            const int inEnd = std::min(numFrames, coreEnd + chunkContextFrames);
+            
+            int numSamples = 0;
+            bool fromModel = false;
+            const float* chunkAudio = runModel(mel, f0, inStart, inEnd, numSamples, fromModel, control);
+            if (chunkAudio == nullptr)
+                return {};
+            ++synthesizedChunks;
+            allFromModel = allFromModel && fromModel;
+            
+            // Overlap-add with linear crossfades centred on the window boundaries
+            const int riseStart = coreStart * hopSize - overlapSamples;
+            const int fallStart = coreEnd * hopSize - overlapSamples;
+            const float rampLength = static_cast<float>(2 * overlapSamples);
+            const int sourceOffset = (outStart - inStart) * hopSize;
+            const int outEndSample = std::min(outEnd * hopSize,
+                                              outStart * hopSize + numSamples - sourceOffset);
+            
+            for (int i = outStart * hopSize; i < outEndSample; ++i)
             {
-                f0Min = std::min(f0Min, freq);
-                f0Max = std::max(f0Max, freq);
-                f0Sum += freq;
-                voicedCount++;
+                float weight = 1.0f;
+                if (!isFirst && i < riseStart + 2 * overlapSamples)
+                    weight = (static_cast<float>(i - riseStart) + 0.5f) / rampLength;
+                else if (!isLast && i >= fallStart)
+                    weight = 1.0f - (static_cast<float>(i - fallStart) + 0.5f) / rampLength;
+                
+                waveform[static_cast<size_t>(i)] += weight * chunkAudio[sourceOffset + i - outStart * hopSize];
             }
         }
-        log("F0 stats: min=" + std::to_string(f0Min) + 
-            " max=" + std::to_string(f0Max) + 
-            " mean=" + std::to_string(voicedCount > 0 ? f0Sum / voicedCount : 0.0f) +
-            " voiced=" + std::to_string(voicedCount) + "/" + std::to_string(numFrames));
-        
-        auto endPrep = std::chrono::high_resolution_clock::now();
-        auto prepMs = std::chrono::duration_cast<std::chrono::milliseconds>(endPrep - startPrep).count();
-        log("Data preparation took " + std::to_string(prepMs) + " ms");
-        
-        // Create memory info
-        auto memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-        
-        // Create input tensors
-        std::vector<Ort::Value> inputTensors;
-        inputTensors.push_back(Ort::Value::CreateTensor<float>(
-            memoryInfo, melData.data(), melData.size(),
-            melShape.data(), melShape.size()));
-        inputTensors.push_back(Ort::Value::CreateTensor<float>(
-            memoryInfo, f0Data.data(), f0Data.size(),
-            f0Shape.data(), f0Shape.size()));
-        
-        // Run inference
-        auto startInfer = std::chrono::high_resolution_clock::now();
-        
-        auto outputTensors = onnxSession->Run(
-            Ort::RunOptions{nullptr},
-            inputNames.data(), inputTensors.data(), inputTensors.size(),
-            outputNames.data(), outputNames.size());
-        
-        auto endInfer = std::chrono::high_resolution_clock::now();
-        auto inferMs = std::chrono::duration_cast<std::chrono::milliseconds>(endInfer - startInfer).count();
-        log("ONNX inference took " + std::to_string(inferMs) + " ms for " + 
-            std::to_string(numFrames) + " frames");
-        
-        // Get output
-        if (outputTensors.empty())
+        
+        // Everything before the next window's crossfade is final
+        const int finalSamples = isLast ? totalSamples : std::min(totalSamples, (coreEnd - chunkOverlapFrames) * hopSize);
+        if (finalSamples > deliveredSamples)
         {
-            log("ONNX inference returned no output");
-            return generateSineFallback(f0);
+            float* region = waveform.data() + deliveredSamples;
+            applySpanGain(region, deliveredSamples, finalSamples, spans, numFrames);
+            applyOutputGain(region, region, finalSamples - deliveredSamples);
+            
+            if (onChunk)
+                onChunk(deliveredSamples, region, finalSamples - deliveredSamples);
+            deliveredSamples = finalSamples;
         }
+    }
+    
+    auto endTotal = std::chrono::high_resolution_clock::now();
+    auto totalMs = std::chrono::duration_cast<std::chrono::milliseconds>(endTotal - startTotal).count();
+    log(LogLevel::Debug, "Chunked synthesis: " + std::to_string(synthesizedChunks) + "/" + std::to_string(numChunks) +
+        " windows of " + std::to_string(chunkFrames) + " frames in " + std::to_string(totalMs) + " ms");
+    
+    return waveform;
+}
+
+void Vocoder::applySpanGain(float* samples, int startSample, int endSample,
+                            const std::vector<std::pair<int, int>>& spans, int numFrames) const
+{
+    if (spans.empty())
+        return;
+    
+    auto clear = [&](int from, int to)
+    {
+        from = std::max(from, startSample);
+        to = std::min(to, endSample);
+        if (from < to)
+            std::fill(samples + (from - startSample), samples + (to - startSample), 0.0f);
+    };
+    
+    int position = startSample;
+    for (const auto& [spanStart, spanEnd] : spans)
+    {
+        const int start = std::clamp(spanStart, 0, numFrames);
+        const int end = std::clamp(spanEnd, 0, numFrames);
+        if (start >= end)
+            continue;
         
-        // Get output tensor info
-        auto& outputTensor = outputTensors[0];
-        auto typeInfo = outputTensor.GetTensorTypeAndShapeInfo();
-        auto outputShape = typeInfo.GetShape();
-        size_t outputSize = typeInfo.GetElementCount();
-        
-        log("ONNX output shape: [" + 
-            std::to_string(outputShape.size() > 0 ? outputShape[0] : 0) + ", " +
-            std::to_string(outputShape.size() > 1 ? outputShape[1] : 0) + ", " +
-            std::to_string(outputShape.size() > 2 ? outputShape[2] : 0) + "]");
-        log("Output samples: " + std::to_string(outputSize));
+        const int first = start * hopSize;
+        const int length = (end - start) * hopSize;
+        const int fade = std::min(spanFadeSamples, length / 2);
         
-        // Copy output to vector
-        float* outputData = outputTensor.GetTensorMutableData<float>();
-        std::vector<float> waveform(outputData, outputData + outputSize);
+        clear(position, first);
         
-        // Analyze output statistics before normalization
-        float minVal = 0.0f, maxVal = 0.0f, sumAbs = 0.0f;
-        for (float sample : waveform)
+        for (int i = std::max(first, startSample); i < std::min(first + length, endSample); ++i)
         {
-            minVal = std::min(minVal, sample);
-            maxVal = std::max(maxVal, sample);
-            sumAbs += std::abs(sample);
+            const int k = i - first;
+            float gain = 1.0f;
+            if (start > 0 && k < fade)
+                gain = static_cast<float>(k) / fade;
+            else if (end < numFrames && k >= length - fade)
+                gain = static_cast<float>(length - k) / fade;
+            
+            samples[i - startSample] *= gain;
         }
-        float maxAbs = std::max(std::abs(minVal), std::abs(maxVal));
-        float avgAbs = sumAbs / waveform.size();
         
-        log("Pre-normalization stats: min=" + std::to_string(minVal) + 
-            " max=" + std::to_string(maxVal) +
-            " maxAbs=" + std::to_string(maxAbs) +
-            " avgAbs=" + std::to_string(avgAbs));
-        
-        // Normalize output to have consistent volume
-        // Target peak around 0.8 to leave headroom
-        const float targetPeak = 0.8f;
+        position = std::max(position, first + length);
+    }
+    
+    clear(position, endSample);
+}
+
+const float* Vocoder::runModel(const MelMatrix& mel, const std::vector<float>& f0, int startFrame, int endFrame,
+                              int& numSamples, bool& fromModel, RunControl* control)
+{
+    fromModel = false;
+    numSamples = 0;
+    
+    const int numFrames = endFrame - startFrame;
+    if (!loaded || startFrame < 0 || numFrames <= 0
+        || endFrame > mel.getNumFrames() || endFrame > static_cast<int>(f0.size()))
+        return nullptr;
+    
+    if (control != nullptr && control->cancelled)
+        return nullptr;
+    
+    auto& context = *inferenceContext;
+    const int expectedSamples = numFrames * hopSize;
+    
+    log(LogLevel::Debug, "Starting inference with " + std::to_string(numFrames) + " frames");
+    
+#ifdef HAVE_ONNXRUNTIME
+    if (!onnxSession || !context.binding || inputNames.size() < 2 || outputNames.empty())
+    {
+        log(LogLevel::Warning, "ONNX session not available, using fallback");
+    }
+    else
+    {
+        const bool preBindOutput = context.bindOutputBuffer && (outputRank == 2 || outputRank == 3);
         
-        if (maxAbs > 0.001f)  // Avoid division by zero
-        {
-            float scale = targetPeak / maxAbs;
-            // Don't amplify too much (max 10x gain)
-            scale = std::min(scale, 10.0f);
+        try {
+            auto startPrep = std::chrono::high_resolution_clock::now();
+            
+            // Mel input [1, num_mels, frames]: a mel-major matrix of exactly
+            // these frames is already in model layout; anything else is
+            // copied (transposed if needed) into the reused input buffer.
+            const size_t melDataSize = static_cast<size_t>(numMels) * numFrames;
+            const bool canBindDirectly = mel.getLayout() == MelMatrix::Layout::MelMajor
+                                      && mel.getNumMels() == numMels
+                                      && startFrame == 0 && endFrame == mel.getNumFrames();
             
-            for (float& sample : waveform)
+            float* melData = const_cast<float*>(mel.data());
+            if (!canBindDirectly)
             {
-                sample *= scale;
+                if (context.melInput.size() < melDataSize)
+                    context.melInput.resize(melDataSize);
+                melData = context.melInput.data();
+                
+                if (mel.getNumMels() == numMels)
+                {
+                    mel.copyFramesTo(startFrame, numFrames, melData, MelMatrix::Layout::MelMajor);
+                }
+                else
+                {
+                    log(LogLevel::Warning, "Mel band count mismatch: got " + std::to_string(mel.getNumMels()) +
+                        ", model expects " + std::to_string(numMels));
+                    std::fill(melData, melData + melDataSize, 0.0f);
+                    const int bands = std::min(numMels, mel.getNumMels());
+                    for (int m = 0; m < bands; ++m)
+                    {
+                        auto band = mel.band(m);
+                        for (int frame = 0; frame < numFrames; ++frame)
+                            melData[static_cast<size_t>(m) * numFrames + frame] = band[startFrame + frame];
+                    }
+                }
             }
-            log("Applied gain scaling: " + std::to_string(scale) + 
-                "x (new peak: " + std::to_string(maxAbs * scale) + ")");
+            
+            // F0 input [1, frames], read in place (ONNX Runtime does not write inputs)
+            float* f0Data = const_cast<float*>(f0.data()) + startFrame;
+            
+            // Log mel statistics (an extra pass, so only when traced)
+            if (isLogEnabled(LogLevel::Trace))
+            {
+                float melMin = 99999.0f, melMax = -99999.0f;
+                for (size_t i = 0; i < melDataSize; ++i)
+                {
+                    melMin = std::min(melMin, melData[i]);
+                    melMax = std::max(melMax, melData[i]);
+                }
+                log(LogLevel::Trace, "Mel stats: min=" + std::to_string(melMin) + " max=" + std::to_string(melMax));
+            }
+            
+            // Log F0 statistics
+            if (isLogEnabled(LogLevel::Trace))
+            {
+                float f0Min = 99999.0f, f0Max = 0.0f, f0Sum = 0.0f;
+                int voicedCount = 0;
+                for (int i = 0; i < numFrames; ++i)
+                {
+                    const float freq = f0Data[i];
+                    if (freq > 0.0f)
+                    {
+                        f0Min = std::min(f0Min, freq);
+                        f0Max = std::max(f0Max, freq);
+                        f0Sum += freq;
+                        voicedCount++;
+                    }
+                }
+                log(LogLevel::Trace, "F0 stats: min=" + std::to_string(f0Min) + 
+                    " max=" + std::to_string(f0Max) + 
+                    " mean=" + std::to_string(voicedCount > 0 ? f0Sum / voicedCount : 0.0f) +
+                    " voiced=" + std::to_string(voicedCount) + "/" + std::to_string(numFrames));
+            }
+            
+            std::array<int64_t, 3> melShape = {1, static_cast<int64_t>(numMels), static_cast<int64_t>(numFrames)};
+            std::array<int64_t, 2> f0Shape = {1, static_cast<int64_t>(numFrames)};
+            
+            Ort::Value melTensor = Ort::Value::CreateTensor<float>(
+                context.memoryInfo, melData, melDataSize,
+                melShape.data(), melShape.size());
+            Ort::Value f0Tensor = Ort::Value::CreateTensor<float>(
+                context.memoryInfo, f0Data, static_cast<size_t>(numFrames),
+                f0Shape.data(), f0Shape.size());
+            
+            context.binding->ClearBoundInputs();
+            context.binding->ClearBoundOutputs();
+            context.binding->BindInput(inputNames[0], melTensor);
+            context.binding->BindInput(inputNames[1], f0Tensor);
+            
+            // Output [1, (1,) samples] straight into the reused buffer when its
+            // shape is known; otherwise ONNX Runtime allocates it
+            Ort::Value outputTensor { nullptr };
+            if (preBindOutput)
+            {
+                if (context.output.size() < static_cast<size_t>(expectedSamples))
+                    context.output.resize(static_cast<size_t>(expectedSamples));
+                
+                std::array<int64_t, 3> outputShape = {1, 1, 1};
+                outputShape[static_cast<size_t>(outputRank) - 1] = expectedSamples;
+                outputTensor = Ort::Value::CreateTensor<float>(
+                    context.memoryInfo, context.output.data(), static_cast<size_t>(expectedSamples),
+                    outputShape.data(), static_cast<size_t>(outputRank));
+                context.binding->BindOutput(outputNames[0], outputTensor);
+            }
+            else
+            {
+                context.binding->BindOutput(outputNames[0], context.memoryInfo);
+            }
+            
+            auto endPrep = std::chrono::high_resolution_clock::now();
+            auto prepMs = std::chrono::duration_cast<std::chrono::milliseconds>(endPrep - startPrep).count();
+            log(LogLevel::Debug, "Data preparation took " + std::to_string(prepMs) + " ms");
+            
+            // Run inference
+            auto startInfer = std::chrono::high_resolution_clock::now();
+            
+            Ort::RunOptions defaultRunOptions{nullptr};
+            const Ort::RunOptions& runOptions = control != nullptr ? control->runOptions : defaultRunOptions;
+            onnxSession->Run(runOptions, *context.binding);
+            
+            auto endInfer = std::chrono::high_resolution_clock::now();
+            auto inferMs = std::chrono::duration_cast<std::chrono::milliseconds>(endInfer - startInfer).count();
+            log(LogLevel::Debug, "ONNX inference took " + std::to_string(inferMs) + " ms for " + 
+                std::to_string(numFrames) + " frames");
+            
+            const float* outputData = nullptr;
+            if (preBindOutput)
+            {
+                outputData = context.output.data();
+                numSamples = expectedSamples;
+            }
+            else
+            {
+                auto outputValues = context.binding->GetOutputValues();
+                if (outputValues.empty())
+                {
+                    log(LogLevel::Error, "ONNX inference returned no output");
+                }
+                else
+                {
+                    context.allocatedOutput = std::move(outputValues[0]);
+                    outputData = context.allocatedOutput.GetTensorData<float>();
+                    numSamples = static_cast<int>(context.allocatedOutput.GetTensorTypeAndShapeInfo().GetElementCount());
+                }
+            }
+            
+            // No output falls through to the sine fallback
+            if (outputData != nullptr)
+            {
+                log(LogLevel::Debug, "Output samples: " + std::to_string(numSamples));
+                
+                fromModel = true;
+                return outputData;
+            }
+            
+        } catch (const Ort::Exception& e) {
+            // RunOptions::SetTerminate makes the run throw
+            if (control != nullptr && control->cancelled)
+            {
+                log(LogLevel::Debug, "ONNX inference cancelled");
+                return nullptr;
+            }
+            
+            if (preBindOutput)
+            {
+                // e.g. a model whose output length is not frames x hop size
+                log(LogLevel::Warning, "Binding the output buffer failed (" + std::string(e.what()) +
+                    "); letting ONNX Runtime allocate it");
+                context.bindOutputBuffer = false;
+                return runModel(mel, f0, startFrame, endFrame, numSamples, fromModel, control);
+            }
+            
+            log(LogLevel::Error, "ONNX inference failed: " + std::string(e.what()));
         }
-        
-        // Final safety clamp
-        for (float& sample : waveform)
+    }
+#endif
+    
+    if (context.output.size() < static_cast<size_t>(expectedSamples))
+        context.output.resize(static_cast<size_t>(expectedSamples));
+    
+    generateSineFallback(f0.data() + startFrame, numFrames, context.output.data());
+    numSamples = expectedSamples;
+    return context.output.data();
+}
+
+void Vocoder::applyOutputGain(const float* source, float* destination, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+    
+    // Level statistics (an extra pass, so only when traced)
+    if (isLogEnabled(LogLevel::Trace))
+    {
+        float minVal = 0.0f, maxVal = 0.0f, sumAbs = 0.0f;
+        for (int i = 0; i < numSamples; ++i)
         {
-            sample = std::clamp(sample, -1.0f, 1.0f);
+            minVal = std::min(minVal, source[i]);
+            maxVal = std::max(maxVal, source[i]);
+            sumAbs += std::abs(source[i]);
         }
         
-        auto endTotal = std::chrono::high_resolution_clock::now();
-        auto totalMs = std::chrono::duration_cast<std::chrono::milliseconds>(endTotal - startTotal).count();
-        log("Total vocoder inference took " + std::to_string(totalMs) + " ms");
-        
-        return waveform;
-        
-    } catch (const Ort::Exception& e) {
-        log("ONNX inference failed: " + std::string(e.what()));
-        return generateSineFallback(f0);
+        log(LogLevel::Trace, "Output stats: min=" + std::to_string(minVal) + 
+            " max=" + std::to_string(maxVal) +
+            " avgAbs=" + std::to_string(sumAbs / numSamples));
     }
-#else
-    return generateSineFallback(f0);
-#endif
+    
+    // Gain and final safety clamp in one pass
+    for (int i = 0; i < numSamples; ++i)
+        destination[i] = std::clamp(source[i] * outputGain, -1.0f, 1.0f);
 }
 
-std::vector<float> Vocoder::inferWithPitchShift(const std::vector<std::vector<float>>& mel,
+std::vector<float> Vocoder::inferWithPitchShift(const MelMatrix& mel,
                                                  const std::vector<float>& f0,
                                                  float pitchShiftSemitones)
 {
@@ -370,51 +750,282 @@ std::vector<float> Vocoder::inferWithPitchShift(const std::vector<std::vector<fl
     return infer(mel, shiftedF0);
 }
 
-void Vocoder::inferAsync(const std::vector<std::vector<float>>& mel,
-                         const std::vector<float>& f0,
-                         std::function<void(std::vector<float>)> callback)
+void Vocoder::RunControl::cancel()
+{
+    cancelled = true;
+#ifdef HAVE_ONNXRUNTIME
+    runOptions.SetTerminate();
+#endif
+}
+
+bool Vocoder::framesOverlap(const SynthesisJob& a, const SynthesisJob& b)
+{
+    return a.startFrame < b.startFrame + b.mel.getNumFrames()
+        && b.startFrame < a.startFrame + a.mel.getNumFrames();
+}
+
+Vocoder::JobHandle Vocoder::submit(SynthesisJob job)
 {
-    // Run inference in background thread
-    std::thread([this, mel, f0, callback]() {
-        auto result = this->infer(mel, f0);
+    // Hashed here, off the lock: a repeated render is answered without queuing
+    const uint64_t cacheKey = SynthesisCache::makeKey(job.mel, job.f0, job.spans,
+                                                      job.chunked ? defaultChunkFrames : 0, settingsHash);
+    auto cached = resultCache.find(cacheKey);
+    
+    std::vector<std::function<void()>> superseded;
+    JobHandle handle = 0;
+    
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        handle = nextHandle++;
         
-        // Call callback on message thread
-        juce::MessageManager::callAsync([callback, result]() {
-            callback(result);
-        });
-    }).detach();
+        // Older work over the same frames is stale
+        for (auto it = jobQueue.begin(); it != jobQueue.end();)
+        {
+            if (framesOverlap(it->job, job))
+            {
+                superseded.push_back(std::move(it->job.onCancelled));
+                it = jobQueue.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        
+        if (runningJob != nullptr && framesOverlap(*runningJob, job))
+            runningControl->cancel();
+        
+        if (cached != nullptr)
+        {
+            // Posted under the lock, so a stale job finishing now cannot land after it
+            log(LogLevel::Debug, "Synthesis served from cache (" + std::to_string(cached->size()) + " samples)");
+            if (job.chunked && job.onChunk)
+            {
+                juce::MessageManager::callAsync([onChunk = std::move(job.onChunk), cached]() {
+                    onChunk(0, cached->data(), static_cast<int>(cached->size()));
+                });
+            }
+            if (job.onComplete)
+            {
+                juce::MessageManager::callAsync([onComplete = std::move(job.onComplete), cached]() {
+                    onComplete(cached);
+                });
+            }
+        }
+        else
+        {
+            jobQueue.push_back({ handle, cacheKey, std::move(job) });
+            
+            if (!worker.joinable())
+                worker = std::thread([this]() { workerLoop(); });
+        }
+    }
+    jobsChanged.notify_all();
+    
+    for (auto& onCancelled : superseded)
+        if (onCancelled)
+            juce::MessageManager::callAsync(std::move(onCancelled));
+    
+    return handle;
 }
 
-std::vector<float> Vocoder::generateSineFallback(const std::vector<float>& f0)
+bool Vocoder::cancel(JobHandle handle)
 {
-    // Fallback: Generate simple sine wave based on F0
-    size_t numFrames = f0.size();
-    size_t numSamples = numFrames * hopSize;
+    std::function<void()> onCancelled;
     
-    std::vector<float> waveform(numSamples, 0.0f);
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        
+        if (handle != 0 && handle == runningHandle)
+        {
+            runningControl->cancel();
+            return true;
+        }
+        
+        auto it = std::find_if(jobQueue.begin(), jobQueue.end(),
+                               [handle](const QueuedJob& queued) { return queued.handle == handle; });
+        if (it == jobQueue.end())
+            return false;
+        
+        onCancelled = std::move(it->job.onCancelled);
+        jobQueue.erase(it);
+    }
     
+    if (onCancelled)
+        juce::MessageManager::callAsync(std::move(onCancelled));
+    return true;
+}
+
+void Vocoder::cancelAll()
+{
+    std::vector<std::function<void()>> cancelled;
+    
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        for (auto& queued : jobQueue)
+            cancelled.push_back(std::move(queued.job.onCancelled));
+        jobQueue.clear();
+        
+        if (runningControl != nullptr)
+            runningControl->cancel();
+    }
+    
+    for (auto& onCancelled : cancelled)
+        if (onCancelled)
+            juce::MessageManager::callAsync(std::move(onCancelled));
+}
+
+bool Vocoder::isPending(JobHandle handle) const
+{
+    std::lock_guard<std::mutex> lock(jobMutex);
+    if (handle != 0 && handle == runningHandle)
+        return true;
+    return std::any_of(jobQueue.begin(), jobQueue.end(),
+                       [handle](const QueuedJob& queued) { return queued.handle == handle; });
+}
+
+bool Vocoder::hasPendingJobs() const
+{
+    std::lock_guard<std::mutex> lock(jobMutex);
+    return runningHandle != 0 || !jobQueue.empty();
+}
+
+void Vocoder::waitUntilIdle()
+{
+    std::unique_lock<std::mutex> lock(jobMutex);
+    jobsChanged.wait(lock, [this]() { return runningHandle == 0; });
+}
+
+void Vocoder::workerLoop()
+{
+    for (;;)
+    {
+        QueuedJob queued;
+        auto control = std::make_shared<RunControl>();
+        
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobsChanged.wait(lock, [this]() { return stopWorker || !jobQueue.empty(); });
+            if (stopWorker)
+                return;
+            
+            // Highest priority first, oldest first within a priority
+            auto next = std::max_element(jobQueue.begin(), jobQueue.end(),
+                [](const QueuedJob& a, const QueuedJob& b)
+                {
+                    if (a.job.priority != b.job.priority)
+                        return a.job.priority < b.job.priority;
+                    return a.handle > b.handle;
+                });
+            
+            runningHandle = next->handle;
+            queued = std::move(*next);
+            jobQueue.erase(next);
+            
+            runningJob = &queued.job;
+            runningControl = control;
+        }
+        
+        // Clears the running state itself, before posting the callback
+        runJob(queued, *control);
+        jobsChanged.notify_all();
+    }
+}
+
+void Vocoder::runJob(QueuedJob& queued, RunControl& control)
+{
+    auto& job = queued.job;
+    std::vector<float> result;
+    bool fromModel = false;
+    
+    // Shares the inference buffers with synchronous callers
+    std::unique_lock<std::mutex> inferenceLock(inferenceMutex);
+    
+    if (job.chunked)
+    {
+        auto onChunk = job.onChunk;
+        result = inferChunkedImpl(job.mel, job.f0, job.spans,
+            [&onChunk, &control](int startSample, const float* samples, int numSamples)
+            {
+                if (onChunk && !control.cancelled)
+                {
+                    // The only copy: the worker keeps writing its waveform
+                    auto chunk = std::make_shared<const std::vector<float>>(samples, samples + numSamples);
+                    juce::MessageManager::callAsync([onChunk, startSample, chunk]() {
+                        onChunk(startSample, chunk->data(), static_cast<int>(chunk->size()));
+                    });
+                }
+            },
+            defaultChunkFrames, &control, fromModel);
+    }
+    else if (job.spans.empty())
+    {
+        result = inferImpl(job.mel, job.f0, &control, fromModel);
+    }
+    else
+    {
+        result = inferSpansImpl(job.mel, job.f0, job.spans, &control, fromModel);
+    }
+    
+    inferenceLock.unlock();
+    
+    // A finished render is valid for its inputs even if it was superseded
+    // meanwhile; the cache and the callback share it. The sine fallback
+    // (e.g. after a transient ONNX Runtime error) is delivered but not cached.
+    Render render;
+    if (!result.empty())
+    {
+        render = std::make_shared<const std::vector<float>>(std::move(result));
+        if (fromModel)
+            resultCache.store(queued.cacheKey, render);
+    }
+    
+    // Call back on message thread, under the lock so a superseding job
+    // served from the cache is delivered after this one. The job stops
+    // counting as pending first, so its own callback doesn't see it.
+    std::lock_guard<std::mutex> lock(jobMutex);
+    runningHandle = 0;
+    runningJob = nullptr;
+    runningControl.reset();
+    
+    if (control.cancelled)
+    {
+        log(LogLevel::Debug, "Synthesis job cancelled");
+        if (job.onCancelled)
+            juce::MessageManager::callAsync(std::move(job.onCancelled));
+    }
+    else if (job.onComplete)
+    {
+        juce::MessageManager::callAsync([onComplete = std::move(job.onComplete), render]() {
+            onComplete(render);
+        });
+    }
+}
+
+void Vocoder::generateSineFallback(const float* f0, int numFrames, float* destination)
+{
+    // Fallback: Generate simple sine wave based on F0
     float phase = 0.0f;
-    for (size_t frame = 0; frame < numFrames; ++frame)
+    for (int frame = 0; frame < numFrames; ++frame)
     {
         float freq = f0[frame];
-        if (freq <= 0.0f) freq = 0.0f;  // Unvoiced
+        float* samples = destination + static_cast<size_t>(frame) * hopSize;
+        
+        if (freq <= 0.0f)
+        {
+            // Unvoiced
+            std::fill(samples, samples + hopSize, 0.0f);
+            continue;
+        }
         
         for (int s = 0; s < hopSize; ++s)
         {
-            size_t sampleIdx = frame * hopSize + s;
-            if (sampleIdx >= numSamples) break;
-            
-            if (freq > 0.0f)
-            {
-                waveform[sampleIdx] = 0.3f * std::sin(phase);
-                phase += 2.0f * juce::MathConstants<float>::pi * freq / sampleRate;
-                if (phase > 2.0f * juce::MathConstants<float>::pi)
-                    phase -= 2.0f * juce::MathConstants<float>::pi;
-            }
+            samples[s] = 0.3f * std::sin(phase);
+            phase += 2.0f * juce::MathConstants<float>::pi * freq / sampleRate;
+            if (phase > 2.0f * juce::MathConstants<float>::pi)
+                phase -= 2.0f * juce::MathConstants<float>::pi;
         }
     }
-    
-    return waveform;
 }
 
 void Vocoder::setExecutionDevice(const juce::String& device)
@@ -422,7 +1033,7 @@ void Vocoder::setExecutionDevice(const juce::String& device)
     if (executionDevice != device)
     {
         executionDevice = device;
-        log("Execution device set to: " + device.toStdString());
+        log(LogLevel::Info, "Execution device set to: " + device.toStdString());
     }
 }
 
@@ -431,7 +1042,7 @@ void Vocoder::setNumThreads(int threads)
     if (inferenceThreads != threads)
     {
         inferenceThreads = threads;
-        log("Thread count set to: " + std::to_string(threads) + 
+        log(LogLevel::Info, "Thread count set to: " + std::to_string(threads) + 
             (threads == 0 ? " (auto)" : ""));
     }
 }
@@ -440,20 +1051,30 @@ bool Vocoder::reloadModel()
 {
     if (!modelFile.existsAsFile())
     {
-        log("Cannot reload: no model file set");
+        log(LogLevel::Warning, "Cannot reload: no model file set");
         return false;
     }
     
-    log("Reloading model with new settings...");
+    log(LogLevel::Info, "Reloading model with new settings...");
+    
+    // The session is about to be replaced under any running job
+    cancelAll();
+    waitUntilIdle();
+    resultCache.clear();
     
 #ifdef HAVE_ONNXRUNTIME
-    // Release existing session
-    onnxSession.reset();
-    inputNames.clear();
-    outputNames.clear();
-    inputNameStrings.clear();
-    outputNameStrings.clear();
-    loaded = false;
+    // Release existing session (synchronous callers may still be inferring)
+    {
+        std::lock_guard<std::mutex> lock(inferenceMutex);
+        inferenceContext->binding.reset();
+        inferenceContext->allocatedOutput = Ort::Value(nullptr);
+        onnxSession.reset();
+        inputNames.clear();
+        outputNames.clear();
+        inputNameStrings.clear();
+        outputNameStrings.clear();
+        loaded = false;
+    }
 #endif
     
     return loadModel(modelFile);
@@ -482,7 +1103,7 @@ Ort::SessionOptions Vocoder::createSessionOptions()
     // Enable CPU memory arena
     sessionOptions.EnableCpuMemArena();
     
-    log("Creating session with device: " + executionDevice.toStdString() + 
+    log(LogLevel::Info, "Creating session with device: " + executionDevice.toStdString() + 
         ", threads: " + std::to_string(numThreads));
     
     // Add execution provider based on device selection
@@ -492,30 +1113,30 @@ Ort::SessionOptions Vocoder::createSessionOptions()
             OrtCUDAProviderOptions cudaOptions{};
             cudaOptions.device_id = 0;
             sessionOptions.AppendExecutionProvider_CUDA(cudaOptions);
-            log("CUDA execution provider added");
+            log(LogLevel::Info, "CUDA execution provider added");
         } catch (const Ort::Exception& e) {
-            log("Failed to add CUDA provider: " + std::string(e.what()));
-            log("Falling back to CPU");
+            log(LogLevel::Warning, "Failed to add CUDA provider: " + std::string(e.what()));
+            log(LogLevel::Warning, "Falling back to CPU");
         }
     }
     else if (executionDevice == "DirectML")
     {
         try {
             sessionOptions.AppendExecutionProvider("DML");
-            log("DirectML execution provider added");
+            log(LogLevel::Info, "DirectML execution provider added");
         } catch (const Ort::Exception& e) {
-            log("Failed to add DirectML provider: " + std::string(e.what()));
-            log("Falling back to CPU");
+            log(LogLevel::Warning, "Failed to add DirectML provider: " + std::string(e.what()));
+            log(LogLevel::Warning, "Falling back to CPU");
         }
     }
     else if (executionDevice == "CoreML")
     {
         try {
             sessionOptions.AppendExecutionProvider("CoreML");
-            log("CoreML execution provider added");
+            log(LogLevel::Info, "CoreML execution provider added");
         } catch (const Ort::Exception& e) {
-            log("Failed to add CoreML provider: " + std::string(e.what()));
-            log("Falling back to CPU");
+            log(LogLevel::Warning, "Failed to add CoreML provider: " + std::string(e.what()));
+            log(LogLevel::Warning, "Falling back to CPU");
         }
     }
     else if (executionDevice == "TensorRT")
@@ -523,10 +1144,10 @@ Ort::SessionOptions Vocoder::createSessionOptions()
         try {
             OrtTensorRTProviderOptions trtOptions{};
             sessionOptions.AppendExecutionProvider_TensorRT(trtOptions);
-            log("TensorRT execution provider added");
+            log(LogLevel::Info, "TensorRT execution provider added");
         } catch (const Ort::Exception& e) {
-            log("Failed to add TensorRT provider: " + std::string(e.what()));
-            log("Falling back to CPU");
+            log(LogLevel::Warning, "Failed to add TensorRT provider: " + std::string(e.what()));
+            log(LogLevel::Warning, "Falling back to CPU");
         }
     }
     // CPU is the default fallback
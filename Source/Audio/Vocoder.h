@@ -1,10 +1,18 @@
 #pragma once
 
 #include "../JuceHeader.h"
+#include "SynthesisCache.h"
+#include "../Utils/AsyncLogger.h"
+#include "../Utils/MelMatrix.h"
 #include <vector>
 #include <functional>
 #include <memory>
-#include <fstream>
+#include <utility>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
 
 #ifdef HAVE_ONNXRUNTIME
 #include <onnxruntime_cxx_api.h>
@@ -13,10 +21,64 @@
 /**
  * PC-NSF-HiFiGAN Vocoder wrapper using ONNX Runtime.
  * Converts mel spectrogram + F0 to waveform with pitch control.
+ *
+ * Asynchronous synthesis goes through one persistent worker thread that runs
+ * submitted jobs one at a time, highest priority first. A job supersedes the
+ * queued and running jobs whose frame range it overlaps: they are dropped,
+ * and a running one is stopped mid-Run, so rapid edits keep the session busy
+ * on the latest state only. Whoever submits the newer job is responsible for
+ * it covering what the older ones would have produced.
+ *
+ * Finished renders go into a SynthesisCache; a job whose inputs were
+ * rendered before is answered from it without reaching the queue.
+ *
+ * The synchronous infer calls may be made from any thread; they wait for
+ * each other and for the worker's current job (so an inferChunked callback
+ * must not call back into the Vocoder).
  */
 class Vocoder
 {
 public:
+    /** Frames per inferChunked window (~6 s at 44.1 kHz). */
+    static constexpr int defaultChunkFrames = 512;
+    
+    /** Called with final output samples [startSample, startSample + numSamples); valid during the call only. */
+    using ChunkCallback = std::function<void(int startSample, const float* samples, int numSamples)>;
+    
+    /** Result of a job, shared with the SynthesisCache (nullptr on failure). */
+    using Render = SynthesisCache::Render;
+    
+    using LogLevel = AsyncLogger::Level;
+    
+    /** Identifies a submitted job; 0 is never a valid handle. */
+    using JobHandle = uint64_t;
+    
+    enum class JobPriority
+    {
+        Background,
+        Normal,         // Full resynthesis
+        Interactive     // Edit previews
+    };
+    
+    /** Work for the synthesis worker. Inputs are moved in, not copied. */
+    struct SynthesisJob
+    {
+        MelMatrix mel;
+        std::vector<float> f0;
+        std::vector<std::pair<int, int>> spans;     // Frames of mel to synthesize (see inferSpans); empty = all
+        
+        int startFrame = 0;                         // Project frame of mel frame 0, for superseding
+        JobPriority priority = JobPriority::Normal;
+        
+        bool chunked = false;                       // inferChunked, delivering through onChunk
+        ChunkCallback onChunk;
+        
+        // Message thread. onComplete gets the result (nullptr on failure);
+        // onCancelled runs instead if the job is superseded or cancelled.
+        std::function<void(Render)> onComplete;
+        std::function<void()> onCancelled;
+    };
+    
     Vocoder();
     ~Vocoder();
     
@@ -39,13 +101,46 @@ public:
     
     /**
      * Synthesize waveform from mel spectrogram and F0.
-     * @param mel Mel spectrogram [T, NUM_MELS] (T frames, each with NUM_MELS values)
+     * MelMajor input with exactly T frames is bound as the model input without copying.
+     * @param mel Mel spectrogram (T frames x NUM_MELS)
      * @param f0 F0 values [T] (fundamental frequency per frame)
      * @return Synthesized waveform, or empty vector on failure
      */
-    std::vector<float> infer(const std::vector<std::vector<float>>& mel,
+    std::vector<float> infer(const MelMatrix& mel,
                               const std::vector<float>& f0);
     
+    /**
+     * Synthesize only the frame spans [start, end) of mel / f0 (e.g. the
+     * active ranges of an ActivityMap) into a result of the full length;
+     * samples outside the spans are zero. The output gets the same fixed
+     * gain as infer(), so a single span covering every frame gives exactly
+     * infer().
+     */
+    std::vector<float> inferSpans(const MelMatrix& mel,
+                                  const std::vector<float>& f0,
+                                  const std::vector<std::pair<int, int>>& spans);
+    
+    /**
+     * Synthesize in windows of chunkFrames frames so model memory stays
+     * bounded on long files and audio is available before the end.
+     *
+     * Each window's model input extends chunkContextFrames past it on both
+     * sides; neighbouring outputs overlap by chunkOverlapFrames on each side
+     * of the boundary and are crossfaded (the weights sum to one). As each
+     * window finishes, onChunk receives the samples that no later window
+     * changes, in order. Windows lying wholly outside spans (if given) are
+     * skipped, and samples outside spans are zeroed as in inferSpans.
+     *
+     * The output gets the same fixed gain as infer(), so a region
+     * re-rendered later matches its neighbours.
+     * @return The whole waveform (frames x hop size), or empty on failure
+     */
+    std::vector<float> inferChunked(const MelMatrix& mel,
+                                    const std::vector<float>& f0,
+                                    const std::vector<std::pair<int, int>>& spans,
+                                    const ChunkCallback& onChunk,
+                                    int chunkFrames = defaultChunkFrames);
+    
     /**
      * Synthesize with pitch shift.
      * @param mel Mel spectrogram
@@ -53,19 +148,30 @@ public:
      * @param pitchShiftSemitones Pitch shift in semitones (+12 = one octave up)
      * @return Synthesized waveform
      */
-    std::vector<float> inferWithPitchShift(const std::vector<std::vector<float>>& mel,
+    std::vector<float> inferWithPitchShift(const MelMatrix& mel,
                                             const std::vector<float>& f0,
                                             float pitchShiftSemitones);
     
     /**
-     * Asynchronous inference with callback.
-     * @param mel Mel spectrogram
-     * @param f0 F0 values
-     * @param callback Called with result on completion
+     * Queue a job on the synthesis worker (started on first use).
+     * @return Handle for cancel() / isPending()
      */
-    void inferAsync(const std::vector<std::vector<float>>& mel,
-                    const std::vector<float>& f0,
-                    std::function<void(std::vector<float>)> callback);
+    JobHandle submit(SynthesisJob job);
+    
+    /** Drop a queued job or stop a running one; false if it already finished. */
+    bool cancel(JobHandle handle);
+    
+    /** Cancel every queued and running job. */
+    void cancelAll();
+    
+    /** True while the job is queued or running. */
+    bool isPending(JobHandle handle) const;
+    
+    /** True while any job is queued or running (a job's own callbacks no longer count it). */
+    bool hasPendingJobs() const;
+    
+    /** Earlier renders, reused when a job's inputs repeat (cleared by reloadModel). */
+    SynthesisCache& getResultCache() { return resultCache; }
     
     // Model parameters
     int getSampleRate() const { return sampleRate; }
@@ -79,7 +185,13 @@ public:
     juce::String getExecutionDevice() const { return executionDevice; }
     int getNumThreads() const { return inferenceThreads; }
     
-    // Reload model with new settings (call after changing device/threads)
+    // Log detail written to vocoder_log.txt (Debug adds per-call timings,
+    // Trace adds input and output statistics)
+    void setLogLevel(LogLevel level);
+    LogLevel getLogLevel() const;
+    
+    // Reload model with new settings (call after changing device/threads);
+    // cancels pending jobs first
     bool reloadModel();
     
 private:
@@ -93,9 +205,112 @@ private:
     int inferenceThreads = 0;  // 0 = auto
     
     juce::File modelFile;
-    std::unique_ptr<std::ofstream> logFile;
+    std::unique_ptr<AsyncLogger> logger;  // vocoder_log.txt
+    
+    void log(LogLevel level, const std::string& message);
+    bool isLogEnabled(LogLevel level) const { return logger->isEnabled(level); }
     
-    void log(const std::string& message);
+    // Fade at span edges that border skipped frames (inferSpans)
+    static constexpr int spanFadeSamples = 256;
+    
+    // inferChunked: model input beyond each window, and crossfade half-width (frames)
+    static constexpr int chunkContextFrames = 32;
+    static constexpr int chunkOverlapFrames = 8;
+    
+    /**
+     * Cancellation state of one job. Checked between spans and windows;
+     * cancel() also terminates a session Run in progress.
+     */
+    struct RunControl
+    {
+        std::atomic<bool> cancelled { false };
+#ifdef HAVE_ONNXRUNTIME
+        Ort::RunOptions runOptions;
+#endif
+        void cancel();
+    };
+    
+    struct QueuedJob
+    {
+        JobHandle handle = 0;
+        uint64_t cacheKey = 0;
+        SynthesisJob job;
+    };
+    
+    // infer / inferSpans / inferChunked, stopping early (empty result) when control is cancelled;
+    // fromModel is false if any window fell back to the sine
+    std::vector<float> inferImpl(const MelMatrix& mel, const std::vector<float>& f0, RunControl* control,
+                                 bool& fromModel);
+    std::vector<float> inferSpansImpl(const MelMatrix& mel, const std::vector<float>& f0,
+                                      const std::vector<std::pair<int, int>>& spans, RunControl* control,
+                                      bool& fromModel);
+    std::vector<float> inferChunkedImpl(const MelMatrix& mel, const std::vector<float>& f0,
+                                        const std::vector<std::pair<int, int>>& spans,
+                                        const ChunkCallback& onChunk, int chunkFrames, RunControl* control,
+                                        bool& fromModel);
+    
+    void workerLoop();
+    void runJob(QueuedJob& queued, RunControl& control);
+    
+    /** Wait until no job is running (the queue may still hold jobs). */
+    void waitUntilIdle();
+    
+    static bool framesOverlap(const SynthesisJob& a, const SynthesisJob& b);
+    
+    std::thread worker;
+    mutable std::mutex jobMutex;
+    std::condition_variable jobsChanged;
+    std::vector<QueuedJob> jobQueue;
+    JobHandle nextHandle = 1;
+    JobHandle runningHandle = 0;                    // 0 when idle
+    SynthesisJob* runningJob = nullptr;             // Range of the running job, for superseding
+    std::shared_ptr<RunControl> runningControl;
+    bool stopWorker = false;
+    
+    // Finished renders by input content; settingsHash identifies the model
+    SynthesisCache resultCache;
+    uint64_t settingsHash = 0;
+    void updateSettingsHash(const juce::File& model);
+    
+    /** Span gain (0 outside spans, faded at edges that border skipped frames) over samples [start, end). */
+    void applySpanGain(float* samples, int startSample, int endSample,
+                       const std::vector<std::pair<int, int>>& spans, int numFrames) const;
+    
+    /**
+     * Model output for frames [startFrame, endFrame) of mel / f0, before the
+     * output gain (or the sine fallback, fromModel = false).
+     *
+     * Inputs are bound in place where their layout allows (f0 always, mel
+     * when it is mel-major and covers exactly these frames), otherwise copied
+     * into a reused buffer; the output is bound to a reused buffer too.
+     * @return numSamples samples, valid until the next call, or nullptr if
+     *         control is cancelled before or during the run
+     */
+    const float* runModel(const MelMatrix& mel, const std::vector<float>& f0, int startFrame, int endFrame,
+                          int& numSamples, bool& fromModel, RunControl* control);
+    
+    /**
+     * Gain applied to model output by every path. Fixed rather than peak
+     * normalized, so full renders, streamed chunks and previews of part of
+     * the file all come out at the same level.
+     */
+    static constexpr float outputGain = 1.0f;
+    
+    /**
+     * Apply outputGain and clamp to [-1, 1], writing to destination in the
+     * same pass (may equal source).
+     */
+    void applyOutputGain(const float* source, float* destination, int numSamples);
+    
+    /**
+     * Reused model input / output buffers and the I/O binding. One inference
+     * at a time: inferenceMutex is held by the public infer calls and the
+     * worker's job for as long as they use runModel's output, and by model
+     * (re)loading.
+     */
+    struct InferenceContext;
+    std::unique_ptr<InferenceContext> inferenceContext;
+    std::mutex inferenceMutex;
     
 #ifdef HAVE_ONNXRUNTIME
     std::unique_ptr<Ort::Env> onnxEnv;
@@ -108,12 +323,15 @@ private:
     std::vector<std::string> inputNameStrings;
     std::vector<std::string> outputNameStrings;
     
+    int outputRank = 0;  // Of the waveform output ([1, samples] or [1, 1, samples]); 0 if unknown
+    
     // Create session options based on current settings
     Ort::SessionOptions createSessionOptions();
 #endif
     
     /**
-     * Generate simple sine wave fallback when ONNX is not available.
+     * Generate simple sine wave fallback when ONNX is not available
+     * (numFrames * hopSize samples into destination).
      */
-    std::vector<float> generateSineFallback(const std::vector<float>& f0);
+    void generateSineFallback(const float* f0, int numFrames, float* destination);
 };
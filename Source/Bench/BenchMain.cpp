@@ -0,0 +1,324 @@
+/*
+    PitchEditorBench - repeatable timings of the analysis and editing kernels
+    on synthetic signals. Needs no audio device, GPU or model files.
+
+    Usage:
+        PitchEditorBench [--seconds 5,30,120] [--iterations 5] [--fft simd|juce]
+                         [--single-thread] [--output results.json]
+
+    Prints (or writes) one JSON document with a result per kernel and length:
+    median / min wall time, ns per frame and frames per second.
+*/
+
+#include "../JuceHeader.h"
+#include "../Audio/PitchDetector.h"
+#include "../Audio/FCPEPitchDetector.h"
+#include "../Models/Project.h"
+#include "../Utils/ActivityMap.h"
+#include "../Utils/Constants.h"
+#include "../Utils/FFTBackend.h"
+#include "../Utils/MelSpectrogram.h"
+#include "../Utils/Resampler.h"
+#include "../Utils/WorkerPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+
+namespace
+{
+    struct Options
+    {
+        std::vector<double> lengthsSeconds { 5.0, 30.0, 120.0 };
+        int iterations = 5;
+        bool multithreaded = true;
+        juce::File output;
+    };
+
+    struct Timing
+    {
+        double medianNs = 0.0;
+        double minNs = 0.0;
+    };
+
+    /** One warm-up run, then the median and minimum of the timed runs. */
+    Timing measure(int iterations, const std::function<void()>& run)
+    {
+        run();
+
+        std::vector<double> times;
+        for (int i = 0; i < iterations; ++i)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            run();
+            const auto end = std::chrono::steady_clock::now();
+            times.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+        }
+
+        std::sort(times.begin(), times.end());
+        return { times[times.size() / 2], times.front() };
+    }
+
+    /**
+     * Sung-vowel-like test signal: a harmonic tone gliding between 150 and
+     * 400 Hz with vibrato, a short silence every two seconds and a little
+     * noise. Deterministic for a given length.
+     */
+    std::vector<float> makeTestSignal(int numSamples, int sampleRate)
+    {
+        std::vector<float> signal(static_cast<size_t>(numSamples));
+        juce::Random random(1234);
+        double phase = 0.0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double t = static_cast<double>(i) / sampleRate;
+            const double glide = 275.0 + 125.0 * std::sin(2.0 * juce::MathConstants<double>::pi * 0.2 * t);
+            const double freq = glide * std::pow(2.0, 0.3 / 12.0 * std::sin(2.0 * juce::MathConstants<double>::pi * 5.5 * t));
+            phase += 2.0 * juce::MathConstants<double>::pi * freq / sampleRate;
+
+            const bool silent = std::fmod(t, 2.0) > 1.8;
+            float sample = 0.0f;
+            if (!silent)
+            {
+                for (int h = 1; h <= 8; ++h)
+                    sample += static_cast<float>(std::sin(phase * h) / h);
+                sample *= 0.25f;
+            }
+
+            signal[static_cast<size_t>(i)] = sample + 0.001f * (random.nextFloat() * 2.0f - 1.0f);
+        }
+
+        return signal;
+    }
+
+    /** FCPE-style output [numFrames][OUT_DIMS]: a Gaussian bump over the cent bins per frame. */
+    std::vector<float> makeTestLatent(int numFrames)
+    {
+        std::vector<float> latent(static_cast<size_t>(numFrames) * FCPEPitchDetector::OUT_DIMS, 0.0f);
+
+        for (int t = 0; t < numFrames; ++t)
+        {
+            const float centre = 180.0f + 120.0f * std::sin(0.01f * t);
+            const float peak = (t % 200) < 180 ? 0.9f : 0.02f;
+            float* frame = latent.data() + static_cast<size_t>(t) * FCPEPitchDetector::OUT_DIMS;
+
+            for (int i = 0; i < FCPEPitchDetector::OUT_DIMS; ++i)
+            {
+                const float d = (i - centre) / 3.0f;
+                frame[i] = peak * std::exp(-0.5f * d * d);
+            }
+        }
+
+        return latent;
+    }
+
+    /** Shift every third note and add vibrato to every fifth, on top of a global offset. */
+    void applyTestEdits(Project& project)
+    {
+        auto& notes = project.getNotes();
+        for (size_t i = 0; i < notes.size(); ++i)
+        {
+            if (i % 3 == 0)
+                notes[i].setPitchOffset(2.0f);
+
+            if (i % 5 == 0)
+            {
+                notes[i].setVibratoEnabled(true);
+                notes[i].setVibratoDepthSemitones(0.5f);
+                notes[i].setVibratoRateHz(5.5f);
+            }
+        }
+
+        project.setGlobalPitchOffset(-1.0f);
+    }
+
+    class Bench
+    {
+    public:
+        explicit Bench(const Options& options) : options(options) {}
+
+        void add(const juce::String& name, double seconds, int numFrames, const std::function<void()>& run)
+        {
+            const auto timing = measure(options.iterations, run);
+            const double frames = std::max(1, numFrames);
+
+            auto* result = new juce::DynamicObject();
+            result->setProperty("name", name);
+            result->setProperty("audioSeconds", seconds);
+            result->setProperty("frames", numFrames);
+            result->setProperty("iterations", options.iterations);
+            result->setProperty("medianNs", timing.medianNs);
+            result->setProperty("minNs", timing.minNs);
+            result->setProperty("nsPerFrame", timing.medianNs / frames);
+            result->setProperty("framesPerSecond", frames * 1.0e9 / timing.medianNs);
+            result->setProperty("realtimeFactor", seconds * 1.0e9 / timing.medianNs);
+            results.add(juce::var(result));
+
+            std::cerr << name << " (" << seconds << " s): "
+                      << timing.medianNs / frames << " ns/frame" << std::endl;
+        }
+
+        juce::var getResults() const { return results; }
+
+    private:
+        const Options& options;
+        juce::Array<juce::var> results;
+    };
+
+    void runLength(Bench& bench, double seconds, bool multithreaded)
+    {
+        const int numSamples = static_cast<int>(seconds * SAMPLE_RATE);
+        const auto audio = makeTestSignal(numSamples, SAMPLE_RATE);
+
+        // Vocoder mel front-end
+        MelSpectrogram melSpectrogram;
+        melSpectrogram.setMultithreaded(multithreaded);
+        const int melFrames = melSpectrogram.getNumFrames(numSamples);
+        bench.add("MelSpectrogram::compute", seconds, melFrames,
+                  [&] { melSpectrogram.compute(audio.data(), numSamples, MelMatrix::Layout::MelMajor); });
+
+        bench.add("ActivityMap::compute", seconds, melFrames,
+                  [&] { ActivityMap::compute(audio.data(), numSamples, HOP_SIZE, N_FFT, melFrames); });
+
+        // YIN
+        PitchDetector pitchDetector(SAMPLE_RATE, HOP_SIZE);
+        pitchDetector.setMultithreaded(multithreaded);
+        auto pitch = pitchDetector.extractF0(audio.data(), numSamples);
+        const int numFrames = static_cast<int>(pitch.first.size());
+        bench.add("PitchDetector::extractF0", seconds, numFrames,
+                  [&] { pitchDetector.extractF0(audio.data(), numSamples); });
+
+        // FCPE stages that run without a model
+        FCPEPitchDetector fcpe;
+        fcpe.setMultithreaded(multithreaded);
+        const int samples16k = static_cast<int>(seconds * FCPEPitchDetector::FCPE_SAMPLE_RATE);
+        const auto audio16k = makeTestSignal(samples16k, FCPEPitchDetector::FCPE_SAMPLE_RATE);
+        const int fcpeFrames = fcpe.getNumFrames(numSamples, SAMPLE_RATE);
+        const Resampler resampler(SAMPLE_RATE, FCPEPitchDetector::FCPE_SAMPLE_RATE);
+        bench.add("Resampler::processBlock (44.1k -> 16k)", seconds, fcpeFrames,
+                  [&] { resampler.processBlock(audio.data(), numSamples); });
+
+        bench.add("FCPEPitchDetector::extractMel", seconds, fcpeFrames,
+                  [&] { fcpe.extractMel(audio16k); });
+
+        const auto latent = makeTestLatent(fcpeFrames);
+        std::vector<float> decoded(static_cast<size_t>(fcpeFrames));
+        bench.add("FCPEPitchDetector::decodeF0", seconds, fcpeFrames,
+                  [&] { fcpe.decodeF0(latent.data(), fcpeFrames, 0.05f, decoded.data()); });
+
+        fcpe.setDecodeMode(FCPEPitchDetector::DecodeMode::Viterbi);
+        bench.add("FCPEPitchDetector::decodeF0 (Viterbi)", seconds, fcpeFrames,
+                  [&] { fcpe.decodeF0(latent.data(), fcpeFrames, 0.05f, decoded.data()); });
+
+        // Editing path, on the YIN pitch
+        Project project;
+        project.getAudioData().f0 = pitch.first;
+        project.getAudioData().voicedMask = pitch.second;
+        bench.add("Project::segmentIntoNotes", seconds, numFrames,
+                  [&] { project.segmentIntoNotes(); });
+
+        applyTestEdits(project);
+
+        bench.add("Project::getAdjustedF0", seconds, numFrames,
+                  [&] { project.getAdjustedF0(); });
+
+        // A typical incremental edit: two seconds in the middle
+        const int rangeFrames = std::min(numFrames, secondsToFrames(2.0f));
+        const int rangeStart = (numFrames - rangeFrames) / 2;
+        bench.add("Project::getAdjustedF0ForRange", seconds, rangeFrames,
+                  [&] { project.getAdjustedF0ForRange(rangeStart, rangeStart + rangeFrames); });
+    }
+
+    std::vector<double> parseLengths(const juce::String& text)
+    {
+        std::vector<double> lengths;
+        for (const auto& token : juce::StringArray::fromTokens(text, ",", ""))
+        {
+            const double seconds = token.trim().getDoubleValue();
+            if (seconds > 0.0)
+                lengths.push_back(seconds);
+        }
+        return lengths;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(argv[i]);
+
+    for (int i = 0; i < args.size(); ++i)
+    {
+        const auto& arg = args[i];
+        const auto next = i + 1 < args.size() ? args[i + 1] : juce::String();
+
+        if (arg == "--seconds" && next.isNotEmpty())
+        {
+            options.lengthsSeconds = parseLengths(next);
+            ++i;
+        }
+        else if (arg == "--iterations" && next.isNotEmpty())
+        {
+            options.iterations = std::max(1, next.getIntValue());
+            ++i;
+        }
+        else if (arg == "--fft" && next.isNotEmpty())
+        {
+            auto type = FFTBackend::getDefaultType();
+            if (!FFTBackend::parseTypeName(next, type))
+            {
+                std::cerr << "Unknown FFT backend: " << next << std::endl;
+                return 1;
+            }
+            FFTBackend::setDefaultType(type);
+            ++i;
+        }
+        else if (arg == "--single-thread")
+        {
+            options.multithreaded = false;
+        }
+        else if (arg == "--output" && next.isNotEmpty())
+        {
+            options.output = juce::File::getCurrentWorkingDirectory().getChildFile(next);
+            ++i;
+        }
+        else
+        {
+            std::cerr << "Usage: PitchEditorBench [--seconds 5,30,120] [--iterations 5] "
+                         "[--fft simd|juce] [--single-thread] [--output results.json]" << std::endl;
+            return 1;
+        }
+    }
+
+    Bench bench(options);
+    for (double seconds : options.lengthsSeconds)
+        runLength(bench, seconds, options.multithreaded);
+
+    const auto fftBackend = FFTBackend::getDefaultType();
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("fftBackend", FFTBackend::getTypeName(fftBackend));
+    root->setProperty("fftCrossCheckError", FFTBackend::crossCheck(fftBackend, 11));
+    root->setProperty("threads", options.multithreaded ? WorkerPool::getInstance().getMaxConcurrency() : 1);
+    root->setProperty("results", bench.getResults());
+
+    const auto json = juce::JSON::toString(juce::var(root));
+    if (options.output != juce::File())
+    {
+        if (!options.output.replaceWithText(json))
+        {
+            std::cerr << "Could not write " << options.output.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        std::cout << json << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,228 @@
+#include "AnalysisCache.h"
+#include "../Utils/Constants.h"
+#include "../Utils/ContentHash.h"
+#include "../Utils/FFTBackend.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    constexpr char entryMagic[4] = { 'P', 'E', 'A', 'C' };
+    constexpr uint32_t entryVersion = 1;
+    const char* const entryExtension = ".peanalysis";
+
+    // Fixed-size header; the payload starts 64-byte aligned so the mel block
+    // can be used straight from a mapping.
+    struct EntryHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t key;
+        uint32_t numFrames;
+        uint32_t numMels;
+        uint32_t melLayout;
+        uint32_t numF0;
+        uint8_t reserved[32];
+    };
+    static_assert(sizeof(EntryHeader) == 64, "Cache entry header must stay 64 bytes");
+
+    size_t getPayloadSize(const EntryHeader& header)
+    {
+        return sizeof(float) * static_cast<size_t>(header.numFrames) * header.numMels
+             + sizeof(float) * static_cast<size_t>(header.numF0)
+             + static_cast<size_t>(header.numF0);
+    }
+}
+
+AnalysisCache::AnalysisCache(const juce::File& directory, int64_t maxSizeBytes)
+    : directory(directory), maxSizeBytes(maxSizeBytes)
+{
+}
+
+juce::File AnalysisCache::getDefaultDirectory()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+               .getChildFile("PitchEditor")
+               .getChildFile("AnalysisCache");
+}
+
+uint64_t AnalysisCache::makeKey(const float* samples, int numSamples,
+                                const juce::String& detectorType, uint64_t detectorHash)
+{
+    ContentHash hash;
+    hash.add(entryVersion);
+    hash.add(SAMPLE_RATE).add(HOP_SIZE).add(N_FFT).add(NUM_MELS).add(FMIN).add(FMAX);
+    hash.add(static_cast<int>(FFTBackend::getDefaultType()));
+
+    const auto type = detectorType.toStdString();
+    hash.update(type.data(), type.size());
+    hash.add(detectorHash);
+
+    hash.add(numSamples);
+    hash.update(samples, sizeof(float) * static_cast<size_t>(numSamples));
+    return hash.getHash();
+}
+
+juce::File AnalysisCache::getEntryFile(uint64_t key) const
+{
+    return directory.getChildFile(juce::String::toHexString(static_cast<juce::int64>(key)).paddedLeft('0', 16)
+                                  + entryExtension);
+}
+
+bool AnalysisCache::contains(uint64_t key)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return getEntryFile(key).existsAsFile();
+}
+
+bool AnalysisCache::load(uint64_t key, AudioData& audioData)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto file = getEntryFile(key);
+    if (!file.existsAsFile())
+        return false;
+
+    juce::MemoryMappedFile mapped(file, juce::MemoryMappedFile::readOnly);
+    const auto* data = static_cast<const uint8_t*>(mapped.getData());
+    if (data == nullptr || mapped.getSize() < sizeof(EntryHeader))
+        return false;
+
+    EntryHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, entryMagic, sizeof(entryMagic)) != 0
+        || header.version != entryVersion
+        || header.key != key
+        || header.numMels != static_cast<uint32_t>(NUM_MELS)
+        || header.melLayout > static_cast<uint32_t>(MelMatrix::Layout::MelMajor)
+        || mapped.getSize() != sizeof(EntryHeader) + getPayloadSize(header))
+    {
+        DBG("AnalysisCache: discarding invalid entry " + file.getFileName());
+        file.deleteFile();
+        return false;
+    }
+
+    const uint8_t* payload = data + sizeof(EntryHeader);
+
+    MelMatrix mel(static_cast<int>(header.numFrames), static_cast<int>(header.numMels),
+                  static_cast<MelMatrix::Layout>(header.melLayout));
+    std::memcpy(mel.data(), payload, sizeof(float) * mel.size());
+    payload += sizeof(float) * mel.size();
+
+    std::vector<float> f0(header.numF0);
+    std::memcpy(f0.data(), payload, sizeof(float) * f0.size());
+    payload += sizeof(float) * f0.size();
+
+    std::vector<bool> voicedMask(header.numF0);
+    for (size_t i = 0; i < voicedMask.size(); ++i)
+        voicedMask[i] = payload[i] != 0;
+
+    audioData.melSpectrogram = std::move(mel);
+    audioData.f0 = std::move(f0);
+    audioData.voicedMask = std::move(voicedMask);
+
+    // Most recently used = most recently modified
+    file.setLastModificationTime(juce::Time::getCurrentTime());
+    return true;
+}
+
+bool AnalysisCache::store(uint64_t key, const AudioData& audioData)
+{
+    const auto& mel = audioData.melSpectrogram;
+    if (mel.empty() || audioData.f0.size() != audioData.voicedMask.size())
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (!directory.isDirectory() && directory.createDirectory().failed())
+            return false;
+
+        EntryHeader header {};
+        std::memcpy(header.magic, entryMagic, sizeof(entryMagic));
+        header.version = entryVersion;
+        header.key = key;
+        header.numFrames = static_cast<uint32_t>(mel.getNumFrames());
+        header.numMels = static_cast<uint32_t>(mel.getNumMels());
+        header.melLayout = static_cast<uint32_t>(mel.getLayout());
+        header.numF0 = static_cast<uint32_t>(audioData.f0.size());
+
+        std::vector<uint8_t> voiced(audioData.voicedMask.size());
+        for (size_t i = 0; i < voiced.size(); ++i)
+            voiced[i] = audioData.voicedMask[i] ? 1 : 0;
+
+        // Write next to the target and swap in, so readers never see a partial entry
+        juce::TemporaryFile temp(getEntryFile(key));
+        {
+            juce::FileOutputStream out(temp.getFile());
+            if (!out.openedOk())
+                return false;
+
+            out.write(&header, sizeof(header));
+            out.write(mel.data(), sizeof(float) * mel.size());
+            out.write(audioData.f0.data(), sizeof(float) * audioData.f0.size());
+            out.write(voiced.data(), voiced.size());
+            out.flush();
+
+            if (out.getStatus().failed())
+                return false;
+        }
+
+        if (!temp.overwriteTargetFileWithTemporary())
+            return false;
+    }
+
+    trimToSize();
+    return true;
+}
+
+void AnalysisCache::setMaxSizeBytes(int64_t newMaxSizeBytes)
+{
+    maxSizeBytes = std::max<int64_t>(0, newMaxSizeBytes);
+}
+
+void AnalysisCache::trimToSize()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!directory.isDirectory())
+        return;
+
+    struct Entry
+    {
+        juce::File file;
+        juce::int64 size;
+        juce::int64 lastUsed;
+    };
+
+    std::vector<Entry> entries;
+    int64_t totalSize = 0;
+
+    for (const auto& file : directory.findChildFiles(juce::File::findFiles, false,
+                                                     juce::String("*") + entryExtension))
+    {
+        Entry entry { file, file.getSize(), file.getLastModificationTime().toMilliseconds() };
+        totalSize += entry.size;
+        entries.push_back(entry);
+    }
+
+    const int64_t budget = maxSizeBytes.load();
+    if (totalSize <= budget)
+        return;
+
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.lastUsed < b.lastUsed; });
+
+    for (const auto& entry : entries)
+    {
+        if (totalSize <= budget)
+            break;
+
+        if (entry.file.deleteFile())
+        {
+            totalSize -= entry.size;
+            DBG("AnalysisCache: evicted " + entry.file.getFileName());
+        }
+    }
+}
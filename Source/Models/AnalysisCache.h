@@ -0,0 +1,69 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "Project.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * Persistent on-disk cache of audio analysis (mel spectrogram, F0, voiced mask).
+ *
+ * Entries are keyed by a hash of the decoded samples together with every
+ * parameter that affects the result (see makeKey), so reopening the same
+ * audio with the same settings skips analysis entirely.
+ *
+ * Each entry is one sidecar file: a fixed 64-byte header followed by the raw
+ * mel values, F0 and voiced flags, so it can be memory-mapped and copied out
+ * without parsing. The directory is kept under a size budget by evicting the
+ * least recently used entries.
+ */
+class AnalysisCache
+{
+public:
+    static constexpr int64_t defaultMaxSizeBytes = 2LL * 1024 * 1024 * 1024;
+
+    explicit AnalysisCache(const juce::File& directory = getDefaultDirectory(),
+                           int64_t maxSizeBytes = defaultMaxSizeBytes);
+
+    /** <userApplicationData>/PitchEditor/AnalysisCache */
+    static juce::File getDefaultDirectory();
+
+    /**
+     * Cache key for analysing the given samples (at SAMPLE_RATE) with the
+     * current analysis constants (SAMPLE_RATE, HOP_SIZE, N_FFT, NUM_MELS,
+     * FMIN, FMAX), FFT backend and the given pitch detector.
+     * @param detectorType e.g. "fcpe" or "yin"
+     * @param detectorHash Model hash (FCPE) or settings hash (YIN)
+     */
+    static uint64_t makeKey(const float* samples, int numSamples,
+                            const juce::String& detectorType, uint64_t detectorHash);
+
+    /** True if an entry exists for key (not validated; load() may still miss). */
+    bool contains(uint64_t key);
+
+    /**
+     * Restore melSpectrogram, f0 and voicedMask from the cache.
+     * @return false on a miss or an unreadable entry (audioData is then untouched)
+     */
+    bool load(uint64_t key, AudioData& audioData);
+
+    /**
+     * Store melSpectrogram, f0 and voicedMask, then evict old entries if the
+     * cache is over budget.
+     */
+    bool store(uint64_t key, const AudioData& audioData);
+
+    void setMaxSizeBytes(int64_t newMaxSizeBytes);
+    int64_t getMaxSizeBytes() const { return maxSizeBytes.load(); }
+
+    /** Delete least recently used entries until the cache fits its budget. */
+    void trimToSize();
+
+private:
+    juce::File getEntryFile(uint64_t key) const;
+
+    juce::File directory;
+    std::atomic<int64_t> maxSizeBytes;
+    std::mutex mutex;  // Serialises file access between load, store and eviction
+};
@@ -153,6 +153,41 @@ bool Project::hasDirtyNotes() const
     return false;
 }
 
+void Project::replaceF0Range(int startFrame, const std::vector<float>& f0, const std::vector<bool>& voicedMask)
+{
+    const int numFrames = static_cast<int>(audioData.f0.size());
+    const int start = std::max(0, startFrame);
+    const int end = std::min({ numFrames, startFrame + static_cast<int>(f0.size()),
+                               startFrame + static_cast<int>(voicedMask.size()) });
+    if (start >= end)
+        return;
+    
+    auto splice = [&](std::vector<float>& dstF0, std::vector<bool>& dstVoiced)
+    {
+        for (int i = start; i < end; ++i)
+        {
+            if (i < static_cast<int>(dstF0.size()))
+                dstF0[i] = f0[i - startFrame];
+            if (i < static_cast<int>(dstVoiced.size()))
+                dstVoiced[i] = voicedMask[i - startFrame];
+        }
+    };
+    
+    splice(audioData.f0, audioData.voicedMask);
+    splice(audioData.originalF0, audioData.originalVoicedMask);
+    
+    for (auto* note : getNotesInRange(start, end))
+    {
+        const int noteEnd = std::min(note->getEndFrame(), numFrames);
+        if (note->getStartFrame() < noteEnd)
+            note->setF0Values(std::vector<float>(audioData.f0.begin() + note->getStartFrame(),
+                                                 audioData.f0.begin() + noteEnd));
+    }
+    
+    setF0DirtyRange(start, end);
+    modified = true;
+}
+
 void Project::setF0DirtyRange(int startFrame, int endFrame)
 {
     if (f0DirtyStart < 0 || startFrame < f0DirtyStart)
@@ -209,6 +244,84 @@ std::pair<int, int> Project::getDirtyFrameRange() const
     return {minStart, maxEnd};
 }
 
+void Project::segmentIntoNotes()
+{
+    notes.clear();
+    
+    if (audioData.f0.empty()) return;
+    
+    // Segment F0 into notes
+    bool inNote = false;
+    int noteStart = 0;
+    float noteF0Sum = 0.0f;
+    int noteF0Count = 0;
+    
+    for (size_t i = 0; i < audioData.f0.size(); ++i)
+    {
+        bool voiced = audioData.voicedMask[i];
+        
+        if (voiced && !inNote)
+        {
+            // Start new note
+            inNote = true;
+            noteStart = static_cast<int>(i);
+            noteF0Sum = audioData.f0[i];
+            noteF0Count = 1;
+        }
+        else if (voiced && inNote)
+        {
+            // Continue note
+            noteF0Sum += audioData.f0[i];
+            noteF0Count++;
+        }
+        else if (!voiced && inNote)
+        {
+            // End note
+            int noteEnd = static_cast<int>(i);
+            int duration = noteEnd - noteStart;
+            
+            if (duration >= 5)  // Minimum note length: 5 frames
+            {
+                float avgF0 = noteF0Sum / noteF0Count;
+                float midi = freqToMidi(avgF0);
+                
+                Note note(noteStart, noteEnd, midi);  // Use noteEnd, not duration
+                
+                // Store F0 values for this note
+                std::vector<float> f0Values(audioData.f0.begin() + noteStart,
+                                            audioData.f0.begin() + noteEnd);
+                note.setF0Values(std::move(f0Values));
+                
+                notes.push_back(note);
+            }
+            
+            inNote = false;
+        }
+    }
+    
+    // Handle note at end
+    if (inNote)
+    {
+        int noteEnd = static_cast<int>(audioData.f0.size());
+        int duration = noteEnd - noteStart;
+        
+        if (duration >= 5)
+        {
+            float avgF0 = noteF0Sum / noteF0Count;
+            float midi = freqToMidi(avgF0);
+            
+            Note note(noteStart, noteEnd, midi);  // Use noteEnd, not duration
+            
+            // Store F0 values for this note
+            std::vector<float> f0Values(audioData.f0.begin() + noteStart,
+                                        audioData.f0.begin() + noteEnd);
+            note.setF0Values(std::move(f0Values));
+            
+            notes.push_back(note);
+        }
+    }
+}
+
 std::vector<float> Project::getAdjustedF0() const
 {
     if (audioData.f0.empty())
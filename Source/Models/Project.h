@@ -2,6 +2,8 @@
 
 #include "../JuceHeader.h"
 #include "Note.h"
+#include "../Utils/MelMatrix.h"
+#include "../Utils/ActivityMap.h"
 #include <vector>
 #include <memory>
 #include <cmath>
@@ -15,13 +17,16 @@ struct AudioData
     int sampleRate = 44100;
     
     // Extracted features
-    std::vector<std::vector<float>> melSpectrogram;  // [T, NUM_MELS]
+    MelMatrix melSpectrogram;                         // T x NUM_MELS (mel-major, vocoder layout)
     std::vector<float> f0;                            // [T]
     std::vector<bool> voicedMask;                     // [T]
 
     // Original (unmodified) pitch extracted from imported audio
     std::vector<float> originalF0;                     // [T]
     std::vector<bool> originalVoicedMask;              // [T]
+
+    // Energy gate of the imported audio; silent frames are not resynthesized
+    ActivityMap activity;                              // [T]
     
     float getDuration() const
     {
@@ -31,7 +36,7 @@ struct AudioData
     
     int getNumFrames() const
     {
-        return static_cast<int>(melSpectrogram.size());
+        return melSpectrogram.getNumFrames();
     }
 };
 
@@ -62,6 +67,12 @@ public:
     void addNote(Note note) { notes.push_back(std::move(note)); }
     void clearNotes() { notes.clear(); }
     
+    /**
+     * Replace the notes with runs of voiced frames (at least 5 frames long),
+     * each pitched at the mean F0 of its run.
+     */
+    void segmentIntoNotes();
+    
     Note* getNoteAtFrame(int frame);
     std::vector<Note*> getNotesInRange(int startFrame, int endFrame);
     std::vector<Note*> getSelectedNotes();
@@ -101,6 +112,14 @@ public:
     // Check if any notes are dirty
     bool hasDirtyNotes() const;
     
+    /**
+     * Splice a re-detected F0 run into f0 / voicedMask and the original
+     * (imported) arrays at startFrame, clipped to the frames that exist.
+     * Notes keep their bounds and edits; their F0 values are refreshed.
+     * Marks the range F0-dirty.
+     */
+    void replaceF0Range(int startFrame, const std::vector<float>& f0, const std::vector<bool>& voicedMask);
+    
     // F0 direct edit dirty tracking (for Draw mode)
     void setF0DirtyRange(int startFrame, int endFrame);
     void clearF0DirtyRange();
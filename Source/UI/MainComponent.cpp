@@ -1,4 +1,5 @@
 #include "MainComponent.h"
+#include "../Audio/AudioImport.h"
 #include "../Utils/Constants.h"
 #include "../Utils/MelSpectrogram.h"
 
@@ -51,6 +52,7 @@ MainComponent::MainComponent(bool enableAudioDevice)
     fcpePitchDetector = std::make_unique<FCPEPitchDetector>();
     vocoder = std::make_unique<Vocoder>();
     undoManager = std::make_unique<PitchUndoManager>(100);
+    analysisCache = std::make_unique<AnalysisCache>();
     
     DBG("MainComponent: Looking for FCPE model...");
     // Try to load FCPE model
@@ -237,6 +239,22 @@ void MainComponent::timerCallback()
         return;
     }
 
+    // Background folder analysis, while nothing else is loading
+    if (batchAnalyzer && batchAnalyzer->isBusy())
+    {
+        const juce::String msg = "Analyzing folder... " + juce::String(batchAnalyzer->getNumFinished()) + " done, "
+                               + juce::String(batchAnalyzer->getNumQueued()) + " queued";
+        toolbar.setProgress(static_cast<float>(batchAnalyzer->getProgress()));
+        
+        if (msg != lastLoadingMessage)
+        {
+            toolbar.showProgress(msg);
+            lastLoadingMessage = msg;
+        }
+        
+        return;
+    }
+
     if (lastLoadingMessage.isNotEmpty())
     {
         toolbar.hideProgress();
@@ -255,6 +273,13 @@ bool MainComponent::keyPressed(const juce::KeyPress& key, juce::Component* /*ori
         return true;
     }
 
+    // Ctrl+Shift+O: Analyze a folder in the background
+    if (key == juce::KeyPress('o', juce::ModifierKeys::ctrlModifier | juce::ModifierKeys::shiftModifier, 0))
+    {
+        analyzeFolder();
+        return true;
+    }
+
     // Ctrl+Z: Undo
     if (key == juce::KeyPress('z', juce::ModifierKeys::ctrlModifier, 0))
     {
@@ -270,6 +295,19 @@ bool MainComponent::keyPressed(const juce::KeyPress& key, juce::Component* /*ori
         return true;
     }
     
+    // Ctrl+R: Re-detect pitch of the selected notes (Ctrl+Shift+R: with YIN)
+    if (key == juce::KeyPress('r', juce::ModifierKeys::ctrlModifier, 0))
+    {
+        redetectSelection(getAnalysisDetector());
+        return true;
+    }
+    
+    if (key == juce::KeyPress('r', juce::ModifierKeys::ctrlModifier | juce::ModifierKeys::shiftModifier, 0))
+    {
+        redetectSelection(*pitchDetector);
+        return true;
+    }
+    
     // D: Toggle draw mode
     if (key == juce::KeyPress('d') || key == juce::KeyPress('D'))
     {
@@ -402,6 +440,57 @@ void MainComponent::openFile()
     });
 }
 
+void MainComponent::analyzeFolder()
+{
+    if (!fcpePitchDetector || !fcpePitchDetector->isLoaded() || !analysisCache)
+    {
+        juce::AlertWindow::showMessageBoxAsync(
+            juce::AlertWindow::WarningIcon,
+            "Analyze Folder",
+            "Batch analysis needs the FCPE model (models/fcpe.onnx).");
+        return;
+    }
+    
+    fileChooser = std::make_unique<juce::FileChooser>(
+        "Select a folder of takes to analyze...",
+        juce::File{});
+    
+    auto chooserFlags = juce::FileBrowserComponent::openMode
+                      | juce::FileBrowserComponent::canSelectDirectories;
+    
+    fileChooser->launchAsync(chooserFlags, [this](const juce::FileChooser& fc)
+    {
+        auto folder = fc.getResult();
+        if (!folder.isDirectory())
+            return;
+        
+        auto files = folder.findChildFiles(juce::File::findFiles, true, "*.wav;*.mp3;*.flac;*.aiff");
+        if (files.isEmpty())
+            return;
+        
+        // One analyzer at a time; a new folder joins the running batch
+        if (!batchAnalyzer)
+        {
+            auto modelsDir = getRuntimeBinaryDir().getChildFile("models");
+            
+            BatchAnalyzer::Options options;
+            options.modelFile = modelsDir.getChildFile("fcpe.onnx");
+            options.melFilterbankFile = modelsDir.getChildFile("mel_filterbank.bin");
+            options.centTableFile = modelsDir.getChildFile("cent_table.bin");
+            
+            batchAnalyzer = std::make_unique<BatchAnalyzer>(*analysisCache, *fcpePitchDetector, options);
+            if (!batchAnalyzer->start())
+            {
+                batchAnalyzer.reset();
+                return;
+            }
+        }
+        
+        batchAnalyzer->addFiles(files);
+        DBG("Batch analysis: queued " << files.size() << " files from " << folder.getFullPathName());
+    });
+}
+
 void MainComponent::loadAudioFile(const juce::File& file)
 {
     if (isLoadingAudio.load())
@@ -449,27 +538,19 @@ void MainComponent::loadAudioFile(const juce::File& file)
         }
 
         // Read audio data
-        const int numSamples = static_cast<int>(reader->lengthInSamples);
         const int srcSampleRate = static_cast<int>(reader->sampleRate);
 
-        juce::AudioBuffer<float> buffer(1, numSamples);
+        juce::AudioBuffer<float> buffer;
 
         updateProgress(0.10, "Reading audio...");
-        if (reader->numChannels == 1)
-        {
-            reader->read(&buffer, 0, numSamples, 0, true, false);
-        }
-        else
+        if (!AudioImport::readMono(*reader, buffer))
         {
-            juce::AudioBuffer<float> stereoBuffer(2, numSamples);
-            reader->read(&stereoBuffer, 0, numSamples, 0, true, true);
-
-            const float* left = stereoBuffer.getReadPointer(0);
-            const float* right = stereoBuffer.getReadPointer(1);
-            float* mono = buffer.getWritePointer(0);
-
-            for (int i = 0; i < numSamples; ++i)
-                mono[i] = (left[i] + right[i]) * 0.5f;
+            juce::MessageManager::callAsync([safeThis]()
+            {
+                if (safeThis != nullptr)
+                    safeThis->isLoadingAudio = false;
+            });
+            return;
         }
 
         if (cancelLoading.load())
@@ -486,26 +567,7 @@ void MainComponent::loadAudioFile(const juce::File& file)
         if (srcSampleRate != SAMPLE_RATE)
         {
             updateProgress(0.18, "Resampling...");
-            const double ratio = static_cast<double>(srcSampleRate) / SAMPLE_RATE;
-            const int newNumSamples = static_cast<int>(numSamples / ratio);
-
-            juce::AudioBuffer<float> resampledBuffer(1, newNumSamples);
-            const float* src = buffer.getReadPointer(0);
-            float* dst = resampledBuffer.getWritePointer(0);
-
-            for (int i = 0; i < newNumSamples; ++i)
-            {
-                const double srcPos = i * ratio;
-                const int srcIndex = static_cast<int>(srcPos);
-                const double frac = srcPos - srcIndex;
-
-                if (srcIndex + 1 < numSamples)
-                    dst[i] = static_cast<float>(src[srcIndex] * (1.0 - frac) + src[srcIndex + 1] * frac);
-                else
-                    dst[i] = src[srcIndex];
-            }
-
-            buffer = std::move(resampledBuffer);
+            AudioImport::resample(buffer, srcSampleRate, SAMPLE_RATE);
         }
 
         updateProgress(0.22, "Preparing project...");
@@ -545,8 +607,19 @@ void MainComponent::loadAudioFile(const juce::File& file)
             if (safeThis == nullptr)
                 return;
 
+            // Synthesis of the old project must not stream into the new one;
+            // callbacks already posted see the generation change and drop out
+            safeThis->vocoder->cancelAll();
+            safeThis->isResynthesizing = false;
+            safeThis->toolbar.setEnabled(true);
+            ++safeThis->projectGeneration;
+
             safeThis->project = std::make_unique<Project>(std::move(*newProject));
 
+            // Undo history points into the old project
+            if (safeThis->undoManager)
+                safeThis->undoManager->clear();
+
             // Update UI
             safeThis->pianoRoll.setProject(safeThis->project.get());
             safeThis->waveform.setProject(safeThis->project.get());
@@ -583,98 +656,53 @@ void MainComponent::analyzeAudio(Project& targetProject, const std::function<voi
     const float* samples = audioData.waveform.getReadPointer(0);
     int numSamples = audioData.waveform.getNumSamples();
     
-    onProgress(0.35, "Computing mel spectrogram...");
-    // Compute mel spectrogram first (to know target frame count)
-    MelSpectrogram melComputer(SAMPLE_RATE, N_FFT, HOP_SIZE, NUM_MELS, FMIN, FMAX);
-    audioData.melSpectrogram = melComputer.compute(samples, numSamples);
+    // Reuse a previous analysis of the same samples with the same settings
+    F0Detector& detector = getAnalysisDetector();
+    const uint64_t cacheKey = AnalysisCache::makeKey(samples, numSamples,
+                                                     detector.getDetectorName(),
+                                                     detector.getSettingsHash());
     
-    int targetFrames = static_cast<int>(audioData.melSpectrogram.size());
-    
-    DBG("Computed mel spectrogram: " << audioData.melSpectrogram.size() << " frames x " 
-        << (audioData.melSpectrogram.empty() ? 0 : audioData.melSpectrogram[0].size()) << " mels");
-    
-    onProgress(0.55, "Extracting pitch (F0)...");
-    // Use FCPE if available, otherwise fall back to YIN
-    if (useFCPE && fcpePitchDetector && fcpePitchDetector->isLoaded())
+    if (analysisCache && analysisCache->load(cacheKey, audioData))
     {
-        DBG("Using FCPE for pitch detection");
-        std::vector<float> fcpeF0 = fcpePitchDetector->extractF0(samples, numSamples, SAMPLE_RATE);
-        
-        DBG("FCPE raw frames: " << fcpeF0.size() << ", target frames: " << targetFrames);
-        
-        // Resample FCPE F0 (100 fps @ 16kHz) to vocoder frame rate (86.1 fps @ 44.1kHz)
-        // FCPE: sr=16000, hop=160 -> 100 fps
-        // Vocoder: sr=44100, hop=512 -> 86.13 fps
-        if (!fcpeF0.empty() && targetFrames > 0)
-        {
-            audioData.f0.resize(targetFrames);
-            double ratio = static_cast<double>(fcpeF0.size()) / targetFrames;
-            
-            for (int i = 0; i < targetFrames; ++i)
-            {
-                double srcPos = i * ratio;
-                int srcIdx = static_cast<int>(srcPos);
-                double frac = srcPos - srcIdx;
-                
-                if (srcIdx + 1 < static_cast<int>(fcpeF0.size()))
-                {
-                    // Linear interpolation, but only between voiced frames
-                    float f0_a = fcpeF0[srcIdx];
-                    float f0_b = fcpeF0[srcIdx + 1];
-                    
-                    if (f0_a > 0 && f0_b > 0)
-                    {
-                        // Both voiced: interpolate
-                        audioData.f0[i] = static_cast<float>(f0_a * (1.0 - frac) + f0_b * frac);
-                    }
-                    else if (f0_a > 0)
-                    {
-                        // Only first voiced
-                        audioData.f0[i] = f0_a;
-                    }
-                    else if (f0_b > 0)
-                    {
-                        // Only second voiced
-                        audioData.f0[i] = f0_b;
-                    }
-                    else
-                    {
-                        // Both unvoiced
-                        audioData.f0[i] = 0.0f;
-                    }
-                }
-                else if (srcIdx < static_cast<int>(fcpeF0.size()))
-                {
-                    audioData.f0[i] = fcpeF0[srcIdx];
-                }
-                else
-                {
-                    audioData.f0[i] = 0.0f;
-                }
-            }
-        }
-        else
-        {
-            audioData.f0.clear();
-        }
-        
-        // Create voiced mask (non-zero F0 = voiced)
-        audioData.voicedMask.resize(audioData.f0.size());
-        for (size_t i = 0; i < audioData.f0.size(); ++i)
-        {
-            audioData.voicedMask[i] = audioData.f0[i] > 0;
-        }
-        
-        DBG("Resampled F0 frames: " << audioData.f0.size());
+        onProgress(0.55, "Loaded cached analysis");
+        DBG("Restored analysis from cache: " << audioData.melSpectrogram.getNumFrames() << " frames");
     }
     else
     {
-        DBG("Using YIN for pitch detection (fallback)");
-        auto [f0Values, voicedValues] = pitchDetector->extractF0(samples, numSamples);
+        onProgress(0.35, "Computing mel spectrogram...");
+        // Compute mel spectrogram first (to know target frame count).
+        // Stored mel-major so the vocoder can bind it without transposing.
+        MelSpectrogram melComputer(SAMPLE_RATE, N_FFT, HOP_SIZE, NUM_MELS, FMIN, FMAX);
+        audioData.melSpectrogram = melComputer.compute(samples, numSamples, MelMatrix::Layout::MelMajor);
+    
+        int targetFrames = audioData.melSpectrogram.getNumFrames();
+    
+        DBG("Computed mel spectrogram: " << audioData.melSpectrogram.getNumFrames() << " frames x " 
+            << audioData.melSpectrogram.getNumMels() << " mels");
+    
+        onProgress(0.55, "Extracting pitch (F0)...");
+        // FCPE if available, otherwise YIN; either reports on the mel frame grid
+        DBG("Using " << detector.getDetectorName() << " for pitch detection");
+        auto [f0Values, voicedValues] = detector.detectF0(
+            samples, numSamples, SAMPLE_RATE, HOP_SIZE, targetFrames,
+            [&onProgress](int done, int total)
+            {
+                onProgress(0.55 + 0.2 * done / total,
+                           "Extracting pitch (F0)... " + juce::String(done) + "/" + juce::String(total));
+            });
         audioData.f0 = std::move(f0Values);
         audioData.voicedMask = std::move(voicedValues);
+        
+        DBG("F0 frames: " << audioData.f0.size());
+        
+        if (analysisCache && !audioData.f0.empty())
+            analysisCache->store(cacheKey, audioData);
     }
 
+    // Silent frames of the imported audio (skipped by resynthesis)
+    audioData.activity = ActivityMap::compute(samples, numSamples, HOP_SIZE, N_FFT,
+                                              audioData.melSpectrogram.getNumFrames());
+
     // Preserve original (unmodified) pitch contour from imported audio
     audioData.originalF0 = audioData.f0;
     audioData.originalVoicedMask = audioData.voicedMask;
@@ -699,13 +727,141 @@ void MainComponent::analyzeAudio(Project& targetProject, const std::function<voi
     
     onProgress(0.90, "Segmenting notes...");
     // Segment into notes
-    segmentIntoNotes(targetProject);
+    targetProject.segmentIntoNotes();
     
     DBG("Loaded audio: " << audioData.waveform.getNumSamples() << " samples");
     DBG("Detected " << audioData.f0.size() << " F0 frames");
     DBG("Segmented into " << project->getNotes().size() << " notes");
 }
 
+F0Detector& MainComponent::getAnalysisDetector()
+{
+    if (useFCPE && fcpePitchDetector && fcpePitchDetector->isReady())
+        return *fcpePitchDetector;
+    return *pitchDetector;
+}
+
+void MainComponent::redetectSelection(F0Detector& detector)
+{
+    if (!project || !detector.isReady()) return;
+    
+    // The loader thread may be running the same detector (and its bound buffers)
+    if (isLoadingAudio.load()) return;
+    
+    auto& audioData = project->getAudioData();
+    const int numFrames = static_cast<int>(audioData.f0.size());
+    if (numFrames == 0) return;
+    
+    // Frames covered by the selected notes
+    int startFrame = numFrames;
+    int endFrame = 0;
+    for (const auto* note : project->getSelectedNotes())
+    {
+        startFrame = std::min(startFrame, note->getStartFrame());
+        endFrame = std::max(endFrame, note->getEndFrame());
+    }
+    startFrame = std::max(0, startFrame);
+    endFrame = std::min(numFrames, endFrame);
+    if (startFrame >= endFrame)
+    {
+        DBG("Re-detect: no notes selected");
+        return;
+    }
+    
+    // Detect on the imported audio (waveform is replaced by resynthesis).
+    // The slice starts on a frame boundary so its frames line up with the file's.
+    const auto& source = hasOriginalWaveform ? originalWaveform : audioData.waveform;
+    const int sliceStartFrame = std::max(0, startFrame - redetectContextFrames);
+    const int sliceEndFrame = std::min(numFrames, endFrame + redetectContextFrames);
+    const int sliceStart = std::min(sliceStartFrame * HOP_SIZE, source.getNumSamples());
+    const int sliceEnd = std::min((sliceEndFrame + 1) * HOP_SIZE + N_FFT / 2, source.getNumSamples());
+    const float* sourceSamples = source.getReadPointer(0);
+    std::vector<float> slice(sourceSamples + sliceStart, sourceSamples + std::max(sliceStart, sliceEnd));
+    
+    DBG("Re-detecting frames " << startFrame << " to " << endFrame << " with " << detector.getDetectorName());
+    
+    // Detection runs on the loader thread; loading blocks new loads and edits
+    // of the project it was started on until the result is spliced in
+    cancelLoading = false;
+    isLoadingAudio = true;
+    loadingProgress = 0.0;
+    {
+        const juce::ScopedLock sl(loadingMessageLock);
+        loadingMessage = "Re-detecting pitch...";
+    }
+    
+    if (loaderThread.joinable())
+        loaderThread.join();
+    
+    const int generation = projectGeneration;
+    loaderThread = std::thread([this, &detector, generation, slice = std::move(slice),
+                                startFrame, endFrame, sliceStartFrame, sliceEndFrame]()
+    {
+        juce::Component::SafePointer<MainComponent> safeThis(this);
+        
+        auto detected = detector.detectF0(slice.data(), static_cast<int>(slice.size()), SAMPLE_RATE, HOP_SIZE,
+                                          sliceEndFrame - sliceStartFrame,
+                                          [this](int done, int total) { loadingProgress = static_cast<double>(done) / total; });
+        
+        juce::MessageManager::callAsync([safeThis, generation, detected = std::move(detected),
+                                         startFrame, endFrame, sliceStartFrame]() mutable
+        {
+            if (safeThis == nullptr)
+                return;
+            
+            safeThis->isLoadingAudio = false;
+            
+            // Keep only the selected frames; the context just feeds the detector
+            const int keepBegin = startFrame - sliceStartFrame;
+            const int keepEnd = endFrame - sliceStartFrame;
+            if (safeThis->projectGeneration != generation
+                || static_cast<int>(detected.first.size()) < keepEnd
+                || static_cast<int>(detected.second.size()) < keepEnd)
+            {
+                DBG("Re-detect: result discarded");
+                return;
+            }
+            
+            safeThis->applyRedetection(startFrame,
+                                       std::vector<float>(detected.first.begin() + keepBegin, detected.first.begin() + keepEnd),
+                                       std::vector<bool>(detected.second.begin() + keepBegin, detected.second.begin() + keepEnd));
+        });
+    });
+}
+
+void MainComponent::applyRedetection(int startFrame, const std::vector<float>& newF0, const std::vector<bool>& newVoiced)
+{
+    auto& audioData = project->getAudioData();
+    const int endFrame = std::min(static_cast<int>(audioData.f0.size()), startFrame + static_cast<int>(newF0.size()));
+    if (startFrame >= endFrame)
+        return;
+    
+    // Undo restores the working curve and the notes' F0 (the original curve keeps the new detection)
+    std::vector<F0FrameEdit> edits;
+    edits.reserve(static_cast<size_t>(endFrame - startFrame));
+    for (int i = startFrame; i < endFrame; ++i)
+    {
+        const bool oldVoiced = i < static_cast<int>(audioData.voicedMask.size()) && audioData.voicedMask[i];
+        edits.push_back(F0FrameEdit { i, audioData.f0[i], newF0[i - startFrame], oldVoiced, newVoiced[i - startFrame] });
+    }
+    
+    std::vector<NoteF0Edit> noteEdits;
+    for (auto* note : project->getNotesInRange(startFrame, endFrame))
+        noteEdits.push_back(NoteF0Edit { note, note->getF0Values(), {} });
+    
+    project->replaceF0Range(startFrame, newF0, newVoiced);
+    
+    for (auto& e : noteEdits)
+        e.newF0 = e.note->getF0Values();
+    
+    if (undoManager)
+        undoManager->addAction(std::make_unique<F0RedetectAction>(&audioData.f0, &audioData.voicedMask,
+                                                                  std::move(edits), std::move(noteEdits)));
+    
+    pianoRoll.repaint();
+    resynthesizeIncremental();
+}
+
 void MainComponent::exportFile()
 {
     if (!project) return;
@@ -815,7 +971,7 @@ void MainComponent::resynthesize()
             "Resynthesize",
             "No mel spectrogram or F0 data. Please load an audio file first.");
         DBG("Cannot resynthesize: no mel spectrogram or F0 data");
-        DBG("  melSpectrogram size: " << audioData.melSpectrogram.size());
+        DBG("  melSpectrogram frames: " << audioData.melSpectrogram.getNumFrames());
         DBG("  f0 size: " << audioData.f0.size());
         return;
     }
@@ -831,9 +987,16 @@ void MainComponent::resynthesize()
     }
     
     DBG("Starting resynthesis...");
-    DBG("  Mel frames: " << audioData.melSpectrogram.size());
+    DBG("  Mel frames: " << audioData.melSpectrogram.getNumFrames());
     DBG("  F0 frames: " << audioData.f0.size());
     
+    if (isResynthesizing)
+    {
+        DBG("Resynthesis already in progress");
+        return;
+    }
+    isResynthesizing = true;
+    
     // Show progress indicator
     toolbar.setEnabled(false);
     parameterPanel.setLoadingStatus("Synthesizing...");
@@ -843,16 +1006,81 @@ void MainComponent::resynthesize()
     
     DBG("  Adjusted F0 frames: " << adjustedF0.size());
     
-    // Run vocoder inference asynchronously
-    vocoder->inferAsync(audioData.melSpectrogram, adjustedF0, 
-        [this](std::vector<float> synthesizedAudio)
+    // Only the frames that are not silent in the imported audio
+    auto spans = audioData.activity.getActiveRanges(0, audioData.melSpectrogram.getNumFrames(),
+                                                    silencePadFrames, silenceMinGapFrames);
+    
+    // This pass covers every edit so far; edits made while it streams mark
+    // the project dirty again and are synthesized when it finishes. If it
+    // fails or is cancelled, the frames dirty now are marked dirty again.
+    const auto renderedDirtyRange = project->getDirtyFrameRange();
+    project->clearAllDirty();
+    
+    // Results for a project that has since been replaced are dropped
+    const int generation = projectGeneration;
+    
+    auto restoreDirty = [this, renderedDirtyRange]()
+        {
+            if (renderedDirtyRange.first >= 0 && renderedDirtyRange.second > renderedDirtyRange.first)
+                project->setF0DirtyRange(renderedDirtyRange.first, renderedDirtyRange.second);
+        };
+    
+    const int totalSamples = static_cast<int>(std::min(static_cast<size_t>(audioData.melSpectrogram.getNumFrames()),
+                                                       adjustedF0.size())) * vocoder->getHopSize();
+    
+    // Run vocoder inference on the synthesis worker, one window at a time.
+    // The job owns its inputs, so the project's mel is copied once here.
+    Vocoder::SynthesisJob job;
+    job.mel = audioData.melSpectrogram;
+    job.f0 = std::move(adjustedF0);
+    job.spans = std::move(spans);
+    job.priority = Vocoder::JobPriority::Normal;
+    job.chunked = true;
+    
+    job.onChunk = [this, totalSamples, generation](int startSample, const float* samples, int numSamples)
+        {
+            if (generation != projectGeneration)
+                return;
+            
+            auto& audioData = project->getAudioData();
+            
+            if (startSample == 0)
+            {
+                // First chunk: the rest of the old audio plays until replaced
+                audioData.waveform.setSize(1, totalSamples, true, true);
+                audioData.waveform.copyFrom(0, 0, samples, std::min(numSamples, totalSamples));
+                audioEngine->loadWaveform(audioData.waveform, audioData.sampleRate);
+                
+                // Playable from here on
+                toolbar.setEnabled(true);
+            }
+            else
+            {
+                const int length = std::min(numSamples, audioData.waveform.getNumSamples() - startSample);
+                if (length <= 0)
+                    return;
+                
+                audioData.waveform.copyFrom(0, startSample, samples, length);
+                audioEngine->updateWaveformRegion(startSample, samples, length);
+            }
+            
+            waveform.repaint();
+        };
+    
+    job.onComplete = [this, restoreDirty, generation](Vocoder::Render render)
         {
+            if (generation != projectGeneration)
+                return;
+            
+            isResynthesizing = false;
+            
             // Re-enable toolbar
             toolbar.setEnabled(true);
             parameterPanel.clearLoadingStatus();
             
-            if (synthesizedAudio.empty())
+            if (render == nullptr || render->empty())
             {
+                restoreDirty();
                 DBG("Resynthesis failed: empty output");
                 juce::AlertWindow::showMessageBoxAsync(
                     juce::AlertWindow::WarningIcon,
@@ -861,28 +1089,31 @@ void MainComponent::resynthesize()
                 return;
             }
             
-            DBG("Resynthesis complete: " << synthesizedAudio.size() << " samples");
-            
-            // Create audio buffer from synthesized audio
-            juce::AudioBuffer<float> newBuffer(1, static_cast<int>(synthesizedAudio.size()));
-            float* dst = newBuffer.getWritePointer(0);
-            std::copy(synthesizedAudio.begin(), synthesizedAudio.end(), dst);
-            
-            // Update project audio data
-            auto& audioData = project->getAudioData();
-            audioData.waveform = std::move(newBuffer);
-            
-            // Reload waveform in audio engine
-            audioEngine->loadWaveform(audioData.waveform, audioData.sampleRate);
+            DBG("Resynthesis complete: " << render->size() << " samples");
             
             // Update UI
             waveform.repaint();
             
             DBG("Resynthesis applied to project");
-                
-            // Clear dirty flags after full resynthesis
-            project->clearAllDirty();
-        });
+            
+            // Edits made while the chunks were streaming
+            if (project->hasDirtyNotes() || project->hasF0DirtyRange())
+                resynthesizeIncremental();
+        };
+    
+    job.onCancelled = [this, restoreDirty, generation]()
+        {
+            if (generation != projectGeneration)
+                return;
+            
+            isResynthesizing = false;
+            toolbar.setEnabled(true);
+            parameterPanel.clearLoadingStatus();
+            restoreDirty();
+            DBG("Resynthesis cancelled");
+        };
+    
+    vocoder->submit(std::move(job));
 }
 
 void MainComponent::resynthesizeIncremental()
@@ -893,6 +1124,9 @@ void MainComponent::resynthesizeIncremental()
     if (audioData.melSpectrogram.empty() || audioData.f0.empty()) return;
     if (!vocoder->isLoaded()) return;
     
+    // A full resynthesis is streaming; it picks up these edits when it finishes
+    if (isResynthesizing) return;
+    
     // Check if there are dirty notes or F0 edits
     if (!project->hasDirtyNotes() && !project->hasF0DirtyRange())
     {
@@ -910,15 +1144,13 @@ void MainComponent::resynthesizeIncremental()
     // Add padding frames for smooth transitions (vocoder needs context)
     const int paddingFrames = 10;
     int startFrame = std::max(0, dirtyStart - paddingFrames);
-    int endFrame = std::min(static_cast<int>(audioData.melSpectrogram.size()), 
+    int endFrame = std::min(audioData.melSpectrogram.getNumFrames(), 
                            dirtyEnd + paddingFrames);
     
     DBG("Incremental synthesis: frames " << startFrame << " to " << endFrame);
     
-    // Extract mel spectrogram range
-    std::vector<std::vector<float>> melRange(
-        audioData.melSpectrogram.begin() + startFrame,
-        audioData.melSpectrogram.begin() + endFrame);
+    // Extract mel spectrogram range (one contiguous copy per mel band)
+    MelMatrix melRange = audioData.melSpectrogram.sliceFrames(startFrame, endFrame);
     
     // Get adjusted F0 for range
     std::vector<float> adjustedF0Range = project->getAdjustedF0ForRange(startFrame, endFrame);
@@ -929,6 +1161,21 @@ void MainComponent::resynthesizeIncremental()
         return;
     }
     
+    // Skip the vocoder entirely when the edit lies in silence
+    auto spans = audioData.activity.getActiveRanges(startFrame, endFrame,
+                                                    silencePadFrames, silenceMinGapFrames);
+    if (spans.empty())
+    {
+        DBG("Incremental synthesis: range is silent");
+        project->clearAllDirty();
+        return;
+    }
+    for (auto& [spanStart, spanEnd] : spans)
+    {
+        spanStart -= startFrame;
+        spanEnd -= startFrame;
+    }
+    
     // Disable toolbar during synthesis
     toolbar.setEnabled(false);
     parameterPanel.setLoadingStatus("Preview...");
@@ -944,20 +1191,35 @@ void MainComponent::resynthesizeIncremental()
     int capturedPaddingFrames = paddingFrames;
     int capturedHopSize = hopSize;
     
-    // Run vocoder inference asynchronously
-    vocoder->inferAsync(melRange, adjustedF0Range, 
-        [this, capturedStartSample, capturedEndSample, capturedPaddingFrames, capturedHopSize]
-        (std::vector<float> synthesizedAudio)
+    // Run vocoder inference on the synthesis worker; this supersedes any
+    // preview still pending for an overlapping range (its frames are still
+    // dirty, so they are part of this range)
+    Vocoder::SynthesisJob job;
+    job.mel = std::move(melRange);
+    job.f0 = std::move(adjustedF0Range);
+    job.spans = std::move(spans);
+    job.startFrame = startFrame;
+    job.priority = Vocoder::JobPriority::Interactive;
+    
+    // Results for a project that has since been replaced are dropped
+    const int generation = projectGeneration;
+    
+    job.onComplete = [this, capturedStartSample, capturedEndSample, capturedPaddingFrames, capturedHopSize, generation]
+        (Vocoder::Render render)
         {
+            if (generation != projectGeneration)
+                return;
+            
             toolbar.setEnabled(true);
             parameterPanel.clearLoadingStatus();
             
-            if (synthesizedAudio.empty())
+            if (render == nullptr || render->empty())
             {
                 DBG("Incremental synthesis failed: empty output");
                 return;
             }
             
+            const auto& synthesizedAudio = *render;
             DBG("Incremental synthesis complete: " << synthesizedAudio.size() << " samples");
             
             auto& audioData = project->getAudioData();
@@ -972,51 +1234,66 @@ void MainComponent::resynthesizeIncremental()
             // Calculate source offset in synthesized audio
             int srcOffset = paddingSamples;
             int replaceSamples = replaceEndSample - replaceStartSample;
+            const float* src = synthesizedAudio.data() + srcOffset;
             
-            // Apply crossfade at boundaries for smooth transitions
-            const int crossfadeSamples = 256;
-            
-            // Copy synthesized audio with crossfade
-            for (int i = 0; i < replaceSamples && (replaceStartSample + i) < totalSamples; ++i)
+            // Samples both the project and the render have
+            const int written = std::min({ replaceSamples, totalSamples - replaceStartSample,
+                                           static_cast<int>(synthesizedAudio.size()) - srcOffset });
+            if (written > 0)
             {
-                int dstIdx = replaceStartSample + i;
-                int srcIdx = srcOffset + i;
+                // Apply crossfade at boundaries for smooth transitions
+                const int crossfadeSamples = 256;
+                const int fadeInEnd = std::min(crossfadeSamples, written);
+                const int fadeOutStart = std::max(fadeInEnd, replaceSamples - crossfadeSamples);
                 
-                if (srcIdx >= 0 && srcIdx < static_cast<int>(synthesizedAudio.size()))
+                // Crossfade at start
+                for (int i = 0; i < fadeInEnd; ++i)
                 {
-                    float srcVal = synthesizedAudio[srcIdx];
-                    
-                    // Crossfade at start
-                    if (i < crossfadeSamples)
-                    {
-                        float t = static_cast<float>(i) / crossfadeSamples;
-                        dst[dstIdx] = dst[dstIdx] * (1.0f - t) + srcVal * t;
-                    }
-                    // Crossfade at end
-                    else if (i >= replaceSamples - crossfadeSamples)
-                    {
-                        float t = static_cast<float>(replaceSamples - i) / crossfadeSamples;
-                        dst[dstIdx] = dst[dstIdx] * (1.0f - t) + srcVal * t;
-                    }
-                    // Direct copy in the middle
-                    else
-                    {
-                        dst[dstIdx] = srcVal;
-                    }
+                    float t = static_cast<float>(i) / crossfadeSamples;
+                    dst[replaceStartSample + i] = dst[replaceStartSample + i] * (1.0f - t) + src[i] * t;
                 }
+                
+                // Direct copy in the middle
+                if (fadeOutStart > fadeInEnd)
+                    juce::FloatVectorOperations::copy(dst + replaceStartSample + fadeInEnd, src + fadeInEnd,
+                                                      std::min(fadeOutStart, written) - fadeInEnd);
+                
+                // Crossfade at end
+                for (int i = fadeOutStart; i < written; ++i)
+                {
+                    float t = static_cast<float>(replaceSamples - i) / crossfadeSamples;
+                    dst[replaceStartSample + i] = dst[replaceStartSample + i] * (1.0f - t) + src[i] * t;
+                }
+                
+                // Only the replaced region changes in the audio engine
+                audioEngine->updateWaveformRegion(replaceStartSample, dst + replaceStartSample, written);
             }
             
-            // Reload waveform in audio engine
-            audioEngine->loadWaveform(audioData.waveform, audioData.sampleRate);
-            
             // Update UI
             waveform.repaint();
             
-            // Clear dirty flags after successful synthesis
-            project->clearAllDirty();
+            // Clear dirty flags after successful synthesis, unless a later
+            // preview (which covers them too) is still to come
+            if (!vocoder->hasPendingJobs())
+                project->clearAllDirty();
             
             DBG("Incremental synthesis applied");
-        });
+        };
+    
+    job.onCancelled = [this, generation]()
+        {
+            if (generation != projectGeneration)
+                return;
+            
+            // Superseded: the newer job restores the toolbar when it finishes
+            if (!vocoder->hasPendingJobs())
+            {
+                toolbar.setEnabled(true);
+                parameterPanel.clearLoadingStatus();
+            }
+        };
+    
+    vocoder->submit(std::move(job));
 }
 
 void MainComponent::onNoteSelected(Note* note)
@@ -1112,87 +1389,7 @@ void MainComponent::setEditMode(EditMode mode)
 void MainComponent::segmentIntoNotes()
 {
     if (!project) return;
-    segmentIntoNotes(*project);
-}
-
-void MainComponent::segmentIntoNotes(Project& targetProject)
-{
-    auto& audioData = targetProject.getAudioData();
-    auto& notes = targetProject.getNotes();
-    notes.clear();
-    
-    if (audioData.f0.empty()) return;
-    
-    // Segment F0 into notes
-    bool inNote = false;
-    int noteStart = 0;
-    float noteF0Sum = 0.0f;
-    int noteF0Count = 0;
-    
-    for (size_t i = 0; i < audioData.f0.size(); ++i)
-    {
-        bool voiced = audioData.voicedMask[i];
-        
-        if (voiced && !inNote)
-        {
-            // Start new note
-            inNote = true;
-            noteStart = static_cast<int>(i);
-            noteF0Sum = audioData.f0[i];
-            noteF0Count = 1;
-        }
-        else if (voiced && inNote)
-        {
-            // Continue note
-            noteF0Sum += audioData.f0[i];
-            noteF0Count++;
-        }
-        else if (!voiced && inNote)
-        {
-            // End note
-            int noteEnd = static_cast<int>(i);
-            int duration = noteEnd - noteStart;
-            
-            if (duration >= 5)  // Minimum note length: 5 frames
-            {
-                float avgF0 = noteF0Sum / noteF0Count;
-                float midi = freqToMidi(avgF0);
-                
-                Note note(noteStart, noteEnd, midi);  // Use noteEnd, not duration
-                
-                // Store F0 values for this note
-                std::vector<float> f0Values(audioData.f0.begin() + noteStart,
-                                            audioData.f0.begin() + noteEnd);
-                note.setF0Values(std::move(f0Values));
-                
-                notes.push_back(note);
-            }
-            
-            inNote = false;
-        }
-    }
-    
-    // Handle note at end
-    if (inNote)
-    {
-        int noteEnd = static_cast<int>(audioData.f0.size());
-        int duration = noteEnd - noteStart;
-        
-        if (duration >= 5)
-        {
-            float avgF0 = noteF0Sum / noteF0Count;
-            float midi = freqToMidi(avgF0);
-            
-            Note note(noteStart, noteEnd, midi);  // Use noteEnd, not duration
-            
-            // Store F0 values for this note
-            std::vector<float> f0Values(audioData.f0.begin() + noteStart,
-                                        audioData.f0.begin() + noteEnd);
-            note.setF0Values(std::move(f0Values));
-            
-            notes.push_back(note);
-        }
-    }
+    project->segmentIntoNotes();
 }
 
 void MainComponent::showSettings()
@@ -1274,6 +1471,27 @@ void MainComponent::loadConfig()
                 // int width = configObj->getProperty("windowWidth");
                 // int height = configObj->getProperty("windowHeight");
                 
+                // FCPE inference chunk length in seconds (0 = whole file)
+                if (configObj->hasProperty("fcpeChunkSeconds") && fcpePitchDetector)
+                    fcpePitchDetector->setChunkLength(static_cast<float>(configObj->getProperty("fcpeChunkSeconds")));
+                
+                // FCPE decoder ("argmax" or "viterbi")
+                if (configObj->hasProperty("fcpeDecoder") && fcpePitchDetector)
+                {
+                    auto mode = fcpePitchDetector->getDecodeMode();
+                    if (FCPEPitchDetector::parseDecodeModeName(configObj->getProperty("fcpeDecoder").toString(), mode))
+                        fcpePitchDetector->setDecodeMode(mode);
+                }
+                
+                // Skip FCPE inference over silence
+                if (configObj->hasProperty("fcpeSkipSilence") && fcpePitchDetector)
+                    fcpePitchDetector->setSkipSilence(static_cast<bool>(configObj->getProperty("fcpeSkipSilence")));
+                
+                // vocoder_log.txt detail ("error" ... "trace")
+                if (configObj->hasProperty("vocoderLogLevel") && vocoder)
+                    vocoder->setLogLevel(AsyncLogger::parseLevel(configObj->getProperty("vocoderLogLevel").toString(),
+                                                                 vocoder->getLogLevel()));
+                
                 DBG("Config loaded from: " + configFile.getFullPathName());
             }
         }
@@ -1298,6 +1516,17 @@ void MainComponent::saveConfig()
     config->setProperty("windowWidth", getWidth());
     config->setProperty("windowHeight", getHeight());
     
+    // Save FCPE chunk length, decoder and silence gate
+    if (fcpePitchDetector)
+    {
+        config->setProperty("fcpeChunkSeconds", fcpePitchDetector->getChunkSeconds());
+        config->setProperty("fcpeDecoder", FCPEPitchDetector::getDecodeModeName(fcpePitchDetector->getDecodeMode()));
+        config->setProperty("fcpeSkipSilence", fcpePitchDetector->getSkipSilence());
+    }
+    
+    if (vocoder)
+        config->setProperty("vocoderLogLevel", AsyncLogger::getLevelName(vocoder->getLogLevel()));
+    
     // Write to file
     juce::String jsonText = juce::JSON::toString(juce::var(config));
     configFile.replaceWithText(jsonText);
@@ -2,7 +2,9 @@
 
 #include "../JuceHeader.h"
 #include "../Models/Project.h"
+#include "../Models/AnalysisCache.h"
 #include "../Audio/AudioEngine.h"
+#include "../Audio/BatchAnalyzer.h"
 #include "../Audio/PitchDetector.h"
 #include "../Audio/FCPEPitchDetector.h"
 #include "../Audio/Vocoder.h"
@@ -51,10 +53,26 @@ private:
     void onPianoRollScrollChanged(double scrollX);
     
     void loadAudioFile(const juce::File& file);
+    
+    /** Pick a folder and analyze every audio file in it into the analysis cache, in the background. */
+    void analyzeFolder();
     void analyzeAudio();
     void analyzeAudio(Project& targetProject, const std::function<void(double, const juce::String&)>& onProgress);
     void segmentIntoNotes();
-    void segmentIntoNotes(Project& targetProject);
+    
+    /** FCPE when its model is loaded, otherwise YIN. */
+    F0Detector& getAnalysisDetector();
+    
+    /**
+     * Re-run detector on the frames of the selected notes (with context
+     * around them) and splice the result into the project's F0, so a bad
+     * phrase can be fixed without re-analyzing the whole file. Runs on the
+     * loader thread; ignored while a file is loading. Undoable.
+     */
+    void redetectSelection(F0Detector& detector);
+    
+    /** Splice re-detected frames from startFrame into the project as one undoable edit. */
+    void applyRedetection(int startFrame, const std::vector<float>& newF0, const std::vector<bool>& newVoiced);
     
     void loadConfig();
     void saveConfig();
@@ -71,8 +89,18 @@ private:
     std::unique_ptr<FCPEPitchDetector> fcpePitchDetector;  // FCPE neural network detector
     std::unique_ptr<Vocoder> vocoder;
     std::unique_ptr<PitchUndoManager> undoManager;
+    std::unique_ptr<AnalysisCache> analysisCache;  // On-disk mel/F0 results by audio hash
+    std::unique_ptr<BatchAnalyzer> batchAnalyzer;  // Background folder analysis (FCPE)
     
     bool useFCPE = true;  // Use FCPE by default if available
+    
+    // Resynthesis skips silence: spans padded by silencePadFrames, gaps
+    // shorter than silenceMinGapFrames (~0.5 s) synthesized anyway
+    static constexpr int silencePadFrames = 8;
+    static constexpr int silenceMinGapFrames = 43;
+    
+    // Frames of audio on each side of the selection fed to re-detection (~0.5 s)
+    static constexpr int redetectContextFrames = 43;
 
     const bool enableAudioDeviceFlag;
     
@@ -90,6 +118,8 @@ private:
     bool hasOriginalWaveform = false;
     
     bool isPlaying = false;
+    bool isResynthesizing = false;  // Full resynthesis streaming in
+    int projectGeneration = 0;      // Bumped when the project is replaced; stale synthesis results are dropped
     
     // Sync flags to prevent infinite loops
     bool isSyncingScroll = false;
@@ -0,0 +1,98 @@
+#include "ActivityMap.h"
+#include "SimdMath.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    int floorDiv(int64_t value, int divisor)
+    {
+        const int64_t quotient = value / divisor;
+        return static_cast<int>(value % divisor < 0 ? quotient - 1 : quotient);
+    }
+}
+
+ActivityMap ActivityMap::compute(const float* audio, int numSamples, int hopSize, int windowSize,
+                                 int numFrames, float thresholdDb)
+{
+    ActivityMap map;
+    numFrames = std::max(0, numFrames);
+    hopSize = std::max(1, hopSize);
+    map.active.assign(static_cast<size_t>(numFrames), 0);
+
+    // Loud blocks, as a prefix count so each frame is one lookup
+    const int numBlocks = (std::max(0, numSamples) + hopSize - 1) / hopSize;
+    const float threshold = std::pow(10.0f, thresholdDb / 10.0f) * static_cast<float>(hopSize);
+
+    std::vector<int> loudPrefix(static_cast<size_t>(numBlocks) + 1, 0);
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        const float* samples = audio + static_cast<size_t>(block) * hopSize;
+        const int length = std::min(hopSize, numSamples - block * hopSize);
+        const bool loud = SimdMath::dotProduct(samples, samples, length) >= threshold;
+        loudPrefix[static_cast<size_t>(block) + 1] = loudPrefix[static_cast<size_t>(block)] + (loud ? 1 : 0);
+    }
+
+    const int halfWindow = std::max(1, windowSize / 2);
+
+    for (int t = 0; t < numFrames; ++t)
+    {
+        const int64_t centre = static_cast<int64_t>(t) * hopSize;
+        const int firstBlock = std::clamp(floorDiv(centre - halfWindow, hopSize), 0, numBlocks);
+        const int lastBlock = std::clamp(floorDiv(centre + halfWindow - 1, hopSize) + 1, 0, numBlocks);
+
+        if (loudPrefix[static_cast<size_t>(lastBlock)] > loudPrefix[static_cast<size_t>(firstBlock)])
+        {
+            map.active[static_cast<size_t>(t)] = 1;
+            ++map.numActiveFrames;
+        }
+    }
+
+    return map;
+}
+
+ActivityMap ActivityMap::allActive(int numFrames)
+{
+    ActivityMap map;
+    map.active.assign(static_cast<size_t>(std::max(0, numFrames)), 1);
+    map.numActiveFrames = map.getNumFrames();
+    return map;
+}
+
+std::vector<std::pair<int, int>> ActivityMap::getActiveRanges(int startFrame, int endFrame,
+                                                              int padFrames, int minGapFrames) const
+{
+    std::vector<std::pair<int, int>> ranges;
+    if (startFrame >= endFrame)
+        return ranges;
+
+    if (empty())
+    {
+        ranges.emplace_back(startFrame, endFrame);
+        return ranges;
+    }
+
+    int frame = startFrame;
+    while (frame < endFrame)
+    {
+        if (!isActive(frame))
+        {
+            ++frame;
+            continue;
+        }
+
+        const int runStart = frame;
+        while (frame < endFrame && isActive(frame))
+            ++frame;
+
+        const int start = std::max(startFrame, runStart - padFrames);
+        const int end = std::min(endFrame, frame + padFrames);
+
+        if (!ranges.empty() && start - ranges.back().second < minGapFrames)
+            ranges.back().second = std::max(ranges.back().second, end);
+        else
+            ranges.emplace_back(start, end);
+    }
+
+    return ranges;
+}
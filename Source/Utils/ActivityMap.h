@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * Per-frame activity (not silence) of an audio buffer, from an energy gate.
+ *
+ * Frame t covers the analysis window centred on sample t * hopSize. The
+ * signal is cut into hop-sized blocks and a frame is active when any block
+ * its window touches has a mean square above the threshold, so the gate is
+ * conservative at onsets and decays. One pass over the samples; cheap enough
+ * to recompute whenever the audio changes.
+ *
+ * Used to skip silent spans in FCPE inference and resynthesis.
+ */
+class ActivityMap
+{
+public:
+    /** Block RMS below this (dBFS) counts as silence. */
+    static constexpr float defaultThresholdDb = -60.0f;
+
+    ActivityMap() = default;
+
+    /**
+     * Gate numFrames frames of audio. Samples outside [0, numSamples) are
+     * silent.
+     */
+    static ActivityMap compute(const float* audio, int numSamples, int hopSize, int windowSize,
+                               int numFrames, float thresholdDb = defaultThresholdDb);
+
+    /** Map where every frame is active (no skipping). */
+    static ActivityMap allActive(int numFrames);
+
+    bool empty() const { return active.empty(); }
+    int getNumFrames() const { return static_cast<int>(active.size()); }
+
+    /** Frames outside the map count as active. */
+    bool isActive(int frame) const
+    {
+        return frame < 0 || frame >= getNumFrames() || active[static_cast<size_t>(frame)] != 0;
+    }
+
+    int getNumActiveFrames() const { return numActiveFrames; }
+
+    /**
+     * Active spans within [startFrame, endFrame), each widened by padFrames
+     * on both sides (clamped to the range), with spans closer than
+     * minGapFrames merged. An empty map yields the whole range.
+     */
+    std::vector<std::pair<int, int>> getActiveRanges(int startFrame, int endFrame,
+                                                     int padFrames, int minGapFrames) const;
+
+private:
+    std::vector<std::uint8_t> active;
+    int numActiveFrames = 0;
+};
@@ -0,0 +1,185 @@
+#include "AsyncLogger.h"
+#include <ctime>
+#include <iomanip>
+
+AsyncLogger::AsyncLogger(const juce::File& file, const juce::String& sessionName, Level initialLevel, size_t capacity)
+    : level(initialLevel)
+{
+    size_t size = 2;
+    while (size < capacity)
+        size <<= 1;
+
+    slots = std::make_unique<Slot[]>(size);
+    mask = size - 1;
+    for (size_t i = 0; i < size; ++i)
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+
+    stream.open(file.getFullPathName().toStdString(), std::ios::app);
+    if (stream.is_open())
+    {
+        const auto time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        stream << "\n========== " << sessionName.toStdString() << " Session Started at " << std::ctime(&time)
+               << " ==========\n";
+        stream.flush();
+    }
+
+    drainThread = std::thread([this]() { drainLoop(); });
+}
+
+AsyncLogger::~AsyncLogger()
+{
+    {
+        std::lock_guard<std::mutex> lock(drainMutex);
+        stopping = true;
+    }
+    drainWake.notify_all();
+    drainThread.join();
+}
+
+const char* AsyncLogger::getLevelName(Level value)
+{
+    switch (value)
+    {
+        case Level::Error:   return "error";
+        case Level::Warning: return "warning";
+        case Level::Info:    return "info";
+        case Level::Debug:   return "debug";
+        case Level::Trace:   return "trace";
+    }
+    return "info";
+}
+
+AsyncLogger::Level AsyncLogger::parseLevel(const juce::String& name, Level fallback)
+{
+    for (auto candidate : { Level::Error, Level::Warning, Level::Info, Level::Debug, Level::Trace })
+        if (name.equalsIgnoreCase(getLevelName(candidate)))
+            return candidate;
+    return fallback;
+}
+
+void AsyncLogger::log(Level messageLevel, std::string message)
+{
+    if (!isEnabled(messageLevel))
+        return;
+
+    if (!tryPush({ messageLevel, std::chrono::system_clock::now(), std::move(message) }))
+        numDropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AsyncLogger::flush()
+{
+    std::unique_lock<std::mutex> lock(drainMutex);
+    const size_t ticket = ++flushRequests;
+    drainWake.notify_all();
+    drained.wait(lock, [this, ticket]() { return flushesDone >= ticket || stopping; });
+}
+
+bool AsyncLogger::tryPush(Record&& record)
+{
+    // Bounded MPMC ring: a slot is free for position pos when its sequence is pos
+    size_t position = enqueuePosition.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+
+    for (;;)
+    {
+        slot = &slots[position & mask];
+        const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+        if (difference == 0)
+        {
+            if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (difference < 0)
+        {
+            return false;  // Full
+        }
+        else
+        {
+            position = enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->record = std::move(record);
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool AsyncLogger::tryPop(Record& record)
+{
+    Slot& slot = slots[dequeuePosition & mask];
+    const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != dequeuePosition + 1)
+        return false;
+
+    record = std::move(slot.record);
+    slot.sequence.store(dequeuePosition + mask + 1, std::memory_order_release);
+    ++dequeuePosition;
+    return true;
+}
+
+void AsyncLogger::drainLoop()
+{
+    std::unique_lock<std::mutex> lock(drainMutex);
+
+    for (;;)
+    {
+        drainWake.wait_for(lock, std::chrono::milliseconds(drainIntervalMs),
+                           [this]() { return stopping || flushRequests > flushesDone; });
+
+        const bool stop = stopping;
+        const size_t requests = flushRequests;
+
+        lock.unlock();
+        writeQueued();
+        lock.lock();
+
+        flushesDone = requests;
+        drained.notify_all();
+
+        if (stop)
+            return;
+    }
+}
+
+void AsyncLogger::writeQueued()
+{
+    Record record;
+    bool wroteAny = false;
+
+    while (tryPop(record))
+    {
+        DBG(record.message);
+
+        if (!stream.is_open())
+            continue;
+
+        const auto time = std::chrono::system_clock::to_time_t(record.time);
+        const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(record.time.time_since_epoch()) % 1000;
+
+        std::tm tm_buf;
+#ifdef _WIN32
+        localtime_s(&tm_buf, &time);
+#else
+        localtime_r(&time, &tm_buf);
+#endif
+
+        stream << std::put_time(&tm_buf, "%H:%M:%S") << "."
+               << std::setfill('0') << std::setw(3) << ms.count()
+               << " | " << std::setfill(' ') << std::left << std::setw(7) << getLevelName(record.level) << std::right
+               << " | " << record.message << "\n";
+        wroteAny = true;
+    }
+
+    const size_t dropped = numDropped.load(std::memory_order_relaxed);
+    if (dropped != numDroppedReported && stream.is_open())
+    {
+        stream << "(" << (dropped - numDroppedReported) << " log messages dropped: queue full)\n";
+        numDroppedReported = dropped;
+        wroteAny = true;
+    }
+
+    if (wroteAny)
+        stream.flush();
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * Levelled log file written off the calling thread.
+ *
+ * log() moves the message and a timestamp into a fixed-size lock-free ring
+ * (multiple producers, one consumer) and returns; a background thread drains
+ * the ring every drainIntervalMs, formats the lines and flushes the file once
+ * per batch. Callers never wait on disk. If the ring is full the message is
+ * dropped and counted, and the count is written with the next batch.
+ *
+ * Check isEnabled() before computing anything only a message needs (e.g.
+ * statistics over a buffer): disabled levels cost one atomic load.
+ */
+class AsyncLogger
+{
+public:
+    enum class Level
+    {
+        Error,
+        Warning,
+        Info,
+        Debug,      // Per-call timings
+        Trace       // Statistics over data buffers
+    };
+
+    static constexpr int drainIntervalMs = 100;
+
+    /**
+     * Append to file (created if needed), starting with a session banner.
+     * @param capacity Ring size, rounded up to a power of two
+     */
+    AsyncLogger(const juce::File& file, const juce::String& sessionName,
+                Level level = Level::Info, size_t capacity = 1024);
+
+    /** Writes whatever is still queued. */
+    ~AsyncLogger();
+
+    void setLevel(Level newLevel) { level.store(newLevel, std::memory_order_relaxed); }
+    Level getLevel() const { return level.load(std::memory_order_relaxed); }
+
+    bool isEnabled(Level messageLevel) const { return messageLevel <= getLevel(); }
+
+    /** Queue message if its level is enabled. Never blocks. */
+    void log(Level messageLevel, std::string message);
+
+    /** Block until everything queued so far is written. */
+    void flush();
+
+    size_t getNumDropped() const { return numDropped.load(); }
+
+    static const char* getLevelName(Level value);
+
+    /** "error", "warning", "info", "debug" or "trace"; fallback if unknown. */
+    static Level parseLevel(const juce::String& name, Level fallback = Level::Info);
+
+private:
+    struct Record
+    {
+        Level level = Level::Info;
+        std::chrono::system_clock::time_point time;
+        std::string message;
+    };
+
+    struct Slot
+    {
+        std::atomic<size_t> sequence { 0 };
+        Record record;
+    };
+
+    bool tryPush(Record&& record);
+    bool tryPop(Record& record);
+
+    void drainLoop();
+    void writeQueued();
+
+    std::atomic<Level> level;
+    std::ofstream stream;
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask = 0;
+    std::atomic<size_t> enqueuePosition { 0 };
+    size_t dequeuePosition = 0;             // Drain thread only
+    std::atomic<size_t> numDropped { 0 };
+    size_t numDroppedReported = 0;          // Drain thread only
+
+    std::thread drainThread;
+    std::mutex drainMutex;                  // Only the drain thread and flush() wait on it
+    std::condition_variable drainWake;
+    std::condition_variable drained;
+    size_t flushRequests = 0;
+    size_t flushesDone = 0;
+    bool stopping = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AsyncLogger)
+};
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+/**
+ * Incremental 64-bit content hash (XXH64 algorithm).
+ *
+ * Used to key cached analysis and synthesis results by the data they were
+ * computed from. Fast enough to hash a long decoded take on every load.
+ * Not cryptographic.
+ */
+class ContentHash
+{
+public:
+    explicit ContentHash(uint64_t seed = 0) : seed(seed)
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        acc[0] = seed + prime1 + prime2;
+        acc[1] = seed + prime2;
+        acc[2] = seed;
+        acc[3] = seed - prime1;
+        totalLength = 0;
+        pendingSize = 0;
+    }
+
+    ContentHash& update(const void* data, size_t size)
+    {
+        auto* p = static_cast<const uint8_t*>(data);
+        totalLength += size;
+
+        // Complete a partially filled stripe first
+        if (pendingSize > 0)
+        {
+            const size_t take = size < stripeSize - pendingSize ? size : stripeSize - pendingSize;
+            std::memcpy(pending + pendingSize, p, take);
+            pendingSize += take;
+            p += take;
+            size -= take;
+
+            if (pendingSize < stripeSize)
+                return *this;
+
+            consumeStripe(pending);
+            pendingSize = 0;
+        }
+
+        for (; size >= stripeSize; p += stripeSize, size -= stripeSize)
+            consumeStripe(p);
+
+        if (size > 0)
+        {
+            std::memcpy(pending, p, size);
+            pendingSize = size;
+        }
+
+        return *this;
+    }
+
+    /** Hash a trivially copyable value by its bytes. */
+    template <typename T>
+    ContentHash& add(const T& value)
+    {
+        return update(&value, sizeof(T));
+    }
+
+    uint64_t getHash() const
+    {
+        uint64_t h;
+
+        if (totalLength >= stripeSize)
+        {
+            h = rotl(acc[0], 1) + rotl(acc[1], 7) + rotl(acc[2], 12) + rotl(acc[3], 18);
+            for (uint64_t v : acc)
+            {
+                h ^= round(0, v);
+                h = h * prime1 + prime4;
+            }
+        }
+        else
+        {
+            h = seed + prime5;
+        }
+
+        h += totalLength;
+
+        const uint8_t* p = pending;
+        size_t remaining = pendingSize;
+
+        for (; remaining >= 8; p += 8, remaining -= 8)
+        {
+            h ^= round(0, read64(p));
+            h = rotl(h, 27) * prime1 + prime4;
+        }
+
+        if (remaining >= 4)
+        {
+            h ^= static_cast<uint64_t>(read32(p)) * prime1;
+            h = rotl(h, 23) * prime2 + prime3;
+            p += 4;
+            remaining -= 4;
+        }
+
+        for (; remaining > 0; ++p, --remaining)
+        {
+            h ^= *p * prime5;
+            h = rotl(h, 11) * prime1;
+        }
+
+        h ^= h >> 33;
+        h *= prime2;
+        h ^= h >> 29;
+        h *= prime3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    /** One-shot hash of a memory block. */
+    static uint64_t of(const void* data, size_t size, uint64_t seed = 0)
+    {
+        return ContentHash(seed).update(data, size).getHash();
+    }
+
+private:
+    static constexpr uint64_t prime1 = 11400714785074694791ULL;
+    static constexpr uint64_t prime2 = 14029467366897019727ULL;
+    static constexpr uint64_t prime3 = 1609587929392839161ULL;
+    static constexpr uint64_t prime4 = 9650029242287828579ULL;
+    static constexpr uint64_t prime5 = 2870177450012600261ULL;
+    static constexpr size_t stripeSize = 32;
+
+    static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+    static uint64_t round(uint64_t a, uint64_t input)
+    {
+        a += input * prime2;
+        a = rotl(a, 31);
+        return a * prime1;
+    }
+
+    // Little-endian loads (all supported targets are little-endian)
+    static uint64_t read64(const uint8_t* p) { uint64_t v; std::memcpy(&v, p, 8); return v; }
+    static uint32_t read32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, 4); return v; }
+
+    void consumeStripe(const uint8_t* p)
+    {
+        for (int lane = 0; lane < 4; ++lane)
+            acc[lane] = round(acc[lane], read64(p + lane * 8));
+    }
+
+    uint64_t seed;
+    uint64_t acc[4];
+    uint64_t totalLength = 0;
+    uint8_t pending[stripeSize];
+    size_t pendingSize = 0;
+};
@@ -0,0 +1,371 @@
+#include "FFTBackend.h"
+#include "SimdMath.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+
+#ifndef PITCH_EDITOR_FFT_BACKEND_DEFAULT
+ #define PITCH_EDITOR_FFT_BACKEND_DEFAULT "simd"
+#endif
+
+namespace
+{
+    class JuceFFT : public FFTBackend
+    {
+    public:
+        explicit JuceFFT(int order) : FFTBackend(order), fft(order) {}
+
+        Type getType() const override { return Type::Juce; }
+
+        void performRealOnlyForwardTransform(float* data) override
+        {
+            fft.performRealOnlyForwardTransform(data, true);
+        }
+
+        void performRealOnlyInverseTransform(float* data) override
+        {
+            fft.performRealOnlyInverseTransform(data);
+        }
+
+    private:
+        juce::dsp::FFT fft;
+    };
+
+    //==============================================================================
+    /**
+     * Real FFT of size N computed as a complex FFT of size N / 2 over the
+     * even/odd sample pairs, followed by the usual split into the real
+     * spectrum. The complex FFT is a radix-2 Stockham (self-sorting, no bit
+     * reversal) on separate real / imaginary arrays; from the third stage on
+     * the butterflies of one stage are contiguous, so they run 4-wide.
+     */
+    class SimdFFT : public FFTBackend
+    {
+    public:
+        explicit SimdFFT(int order)
+            : FFTBackend(order),
+              half(getSize() / 2)
+        {
+            const size_t m = static_cast<size_t>(half);
+            bufferRe.resize(m);
+            bufferIm.resize(m);
+            workRe.resize(m);
+            workIm.resize(m);
+
+            // Stage twiddles exp(-2 pi i p / n) for n = half, half / 2, ..., 2
+            for (int n = half; n > 1; n /= 2)
+            {
+                for (int p = 0; p < n / 2; ++p)
+                {
+                    const double angle = 2.0 * juce::MathConstants<double>::pi * p / n;
+                    stageCos.push_back(static_cast<float>(std::cos(angle)));
+                    stageSin.push_back(static_cast<float>(-std::sin(angle)));
+                }
+            }
+
+            // Split twiddles exp(-2 pi i k / N) for k = 0..N/2
+            splitCos.resize(m + 1);
+            splitSin.resize(m + 1);
+            for (int k = 0; k <= half; ++k)
+            {
+                const double angle = 2.0 * juce::MathConstants<double>::pi * k / getSize();
+                splitCos[static_cast<size_t>(k)] = static_cast<float>(std::cos(angle));
+                splitSin[static_cast<size_t>(k)] = static_cast<float>(-std::sin(angle));
+            }
+        }
+
+        Type getType() const override { return Type::Simd; }
+
+        void performRealOnlyForwardTransform(float* data) override
+        {
+            for (int k = 0; k < half; ++k)
+            {
+                bufferRe[static_cast<size_t>(k)] = data[2 * k];
+                bufferIm[static_cast<size_t>(k)] = data[2 * k + 1];
+            }
+
+            const auto z = transform(false);
+            const float* zr = z.first;
+            const float* zi = z.second;
+
+            for (int k = 0; k <= half; ++k)
+            {
+                const int a = k % half;
+                const int b = (half - k) % half;
+
+                // Z[k] and conj(Z[N/2 - k])
+                const float xr = zr[a], xi = zi[a];
+                const float yr = zr[b], yi = -zi[b];
+
+                const float evenRe = 0.5f * (xr + yr);
+                const float evenIm = 0.5f * (xi + yi);
+
+                // -i * (Z[k] - conj(Z[N/2 - k])) / 2
+                const float oddRe = 0.5f * (xi - yi);
+                const float oddIm = -0.5f * (xr - yr);
+
+                const float wr = splitCos[static_cast<size_t>(k)];
+                const float wi = splitSin[static_cast<size_t>(k)];
+
+                data[2 * k]     = evenRe + (oddRe * wr - oddIm * wi);
+                data[2 * k + 1] = evenIm + (oddRe * wi + oddIm * wr);
+            }
+        }
+
+        void performRealOnlyInverseTransform(float* data) override
+        {
+            for (int k = 0; k < half; ++k)
+            {
+                const float xr = data[2 * k], xi = data[2 * k + 1];
+                const float yr = data[2 * (half - k)], yi = -data[2 * (half - k) + 1];
+
+                const float evenRe = 0.5f * (xr + yr);
+                const float evenIm = 0.5f * (xi + yi);
+
+                // (X[k] - conj(X[N/2 - k])) / 2 * conj(w^k)
+                const float diffRe = 0.5f * (xr - yr);
+                const float diffIm = 0.5f * (xi - yi);
+                const float wr = splitCos[static_cast<size_t>(k)];
+                const float wi = -splitSin[static_cast<size_t>(k)];
+                const float oddRe = diffRe * wr - diffIm * wi;
+                const float oddIm = diffRe * wi + diffIm * wr;
+
+                bufferRe[static_cast<size_t>(k)] = evenRe - oddIm;
+                bufferIm[static_cast<size_t>(k)] = evenIm + oddRe;
+            }
+
+            const auto z = transform(true);
+            const float scale = 1.0f / static_cast<float>(half);
+
+            for (int k = 0; k < half; ++k)
+            {
+                data[2 * k]     = z.first[k] * scale;
+                data[2 * k + 1] = z.second[k] * scale;
+            }
+        }
+
+    private:
+        /**
+         * Unscaled complex FFT of bufferRe / bufferIm; returns the arrays
+         * holding the result (either the buffers or the work arrays).
+         */
+        std::pair<const float*, const float*> transform(bool inverse)
+        {
+            float* xr = bufferRe.data();
+            float* xi = bufferIm.data();
+            float* yr = workRe.data();
+            float* yi = workIm.data();
+
+            const float sign = inverse ? -1.0f : 1.0f;
+            const float* twiddleCos = stageCos.data();
+            const float* twiddleSin = stageSin.data();
+
+            // Stage with sub-transform length n and stride s:
+            // y[q + s*2p] = a + b, y[q + s*(2p+1)] = (a - b) * w^p,
+            // with a = x[q + s*p], b = x[q + s*(p + n/2)]
+            for (int n = half, s = 1; n > 1; n /= 2, s *= 2)
+            {
+                const int m = n / 2;
+
+                for (int p = 0; p < m; ++p)
+                {
+                    const float wr = twiddleCos[p];
+                    const float wi = sign * twiddleSin[p];
+
+                    const float* ar = xr + s * p;
+                    const float* ai = xi + s * p;
+                    const float* br = xr + s * (p + m);
+                    const float* bi = xi + s * (p + m);
+                    float* sumRe = yr + s * 2 * p;
+                    float* sumIm = yi + s * 2 * p;
+                    float* diffRe = yr + s * (2 * p + 1);
+                    float* diffIm = yi + s * (2 * p + 1);
+
+                    int q = 0;
+#if PITCH_EDITOR_SIMD_SSE
+                    const __m128 vwr = _mm_set1_ps(wr);
+                    const __m128 vwi = _mm_set1_ps(wi);
+                    for (; q + 4 <= s; q += 4)
+                    {
+                        const __m128 xar = _mm_loadu_ps(ar + q), xai = _mm_loadu_ps(ai + q);
+                        const __m128 xbr = _mm_loadu_ps(br + q), xbi = _mm_loadu_ps(bi + q);
+                        const __m128 dr = _mm_sub_ps(xar, xbr), di = _mm_sub_ps(xai, xbi);
+                        _mm_storeu_ps(sumRe + q, _mm_add_ps(xar, xbr));
+                        _mm_storeu_ps(sumIm + q, _mm_add_ps(xai, xbi));
+                        _mm_storeu_ps(diffRe + q, _mm_sub_ps(_mm_mul_ps(dr, vwr), _mm_mul_ps(di, vwi)));
+                        _mm_storeu_ps(diffIm + q, _mm_add_ps(_mm_mul_ps(dr, vwi), _mm_mul_ps(di, vwr)));
+                    }
+#elif PITCH_EDITOR_SIMD_NEON
+                    const float32x4_t vwr = vdupq_n_f32(wr);
+                    const float32x4_t vwi = vdupq_n_f32(wi);
+                    for (; q + 4 <= s; q += 4)
+                    {
+                        const float32x4_t xar = vld1q_f32(ar + q), xai = vld1q_f32(ai + q);
+                        const float32x4_t xbr = vld1q_f32(br + q), xbi = vld1q_f32(bi + q);
+                        const float32x4_t dr = vsubq_f32(xar, xbr), di = vsubq_f32(xai, xbi);
+                        vst1q_f32(sumRe + q, vaddq_f32(xar, xbr));
+                        vst1q_f32(sumIm + q, vaddq_f32(xai, xbi));
+                        vst1q_f32(diffRe + q, vsubq_f32(vmulq_f32(dr, vwr), vmulq_f32(di, vwi)));
+                        vst1q_f32(diffIm + q, vaddq_f32(vmulq_f32(dr, vwi), vmulq_f32(di, vwr)));
+                    }
+#endif
+                    for (; q < s; ++q)
+                    {
+                        const float dr = ar[q] - br[q];
+                        const float di = ai[q] - bi[q];
+                        sumRe[q] = ar[q] + br[q];
+                        sumIm[q] = ai[q] + bi[q];
+                        diffRe[q] = dr * wr - di * wi;
+                        diffIm[q] = dr * wi + di * wr;
+                    }
+                }
+
+                std::swap(xr, yr);
+                std::swap(xi, yi);
+                twiddleCos += m;
+                twiddleSin += m;
+            }
+
+            return { xr, xi };
+        }
+
+        int half;
+        std::vector<float> bufferRe, bufferIm;
+        std::vector<float> workRe, workIm;
+        std::vector<float> stageCos, stageSin;
+        std::vector<float> splitCos, splitSin;
+    };
+
+    FFTBackend::Type getInitialDefaultType()
+    {
+        FFTBackend::Type type = FFTBackend::Type::Simd;
+        FFTBackend::parseTypeName(PITCH_EDITOR_FFT_BACKEND_DEFAULT, type);
+
+        if (const char* env = std::getenv("PITCH_EDITOR_FFT_BACKEND"))
+        {
+            if (!FFTBackend::parseTypeName(env, type))
+                DBG("FFTBackend: ignoring unknown PITCH_EDITOR_FFT_BACKEND=" + juce::String(env));
+        }
+
+        return type;
+    }
+
+    std::atomic<int>& getDefaultTypeStorage()
+    {
+        static std::atomic<int> type { static_cast<int>(getInitialDefaultType()) };
+        return type;
+    }
+}
+
+//==============================================================================
+std::unique_ptr<FFTBackend> FFTBackend::createUnchecked(int order, Type type)
+{
+    jassert(order >= 1);
+
+    switch (type)
+    {
+        case Type::Simd: return std::make_unique<SimdFFT>(order);
+        case Type::Juce: break;
+    }
+
+    return std::make_unique<JuceFFT>(order);
+}
+
+std::unique_ptr<FFTBackend> FFTBackend::create(int order, Type type)
+{
+#if JUCE_DEBUG
+    if (type != Type::Juce)
+    {
+        static std::mutex mutex;
+        static std::set<std::pair<int, int>> checked;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (checked.insert({ static_cast<int>(type), order }).second)
+        {
+            const float error = crossCheck(type, order);
+            DBG("FFTBackend: " + juce::String(getTypeName(type)) + " order " + juce::String(order)
+                + " cross-check error " + juce::String(error));
+            jassert(error <= crossCheckTolerance);
+        }
+    }
+#endif
+
+    return createUnchecked(order, type);
+}
+
+FFTBackend::Type FFTBackend::getDefaultType()
+{
+    return static_cast<Type>(getDefaultTypeStorage().load());
+}
+
+void FFTBackend::setDefaultType(Type type)
+{
+    getDefaultTypeStorage().store(static_cast<int>(type));
+}
+
+const char* FFTBackend::getTypeName(Type type)
+{
+    switch (type)
+    {
+        case Type::Juce: return "juce";
+        case Type::Simd: return "simd";
+    }
+
+    return "juce";
+}
+
+bool FFTBackend::parseTypeName(const juce::String& name, Type& type)
+{
+    for (auto candidate : { Type::Juce, Type::Simd })
+    {
+        if (name.trim().equalsIgnoreCase(getTypeName(candidate)))
+        {
+            type = candidate;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+float FFTBackend::crossCheck(Type type, int order)
+{
+    auto candidate = createUnchecked(order, type);
+    auto reference = createUnchecked(order, Type::Juce);
+    const int size = candidate->getSize();
+
+    std::vector<float> signal(static_cast<size_t>(size));
+    juce::Random random(0x5eed);
+    for (auto& sample : signal)
+        sample = random.nextFloat() * 2.0f - 1.0f;
+
+    std::vector<float> candidateData(static_cast<size_t>(size) * 2, 0.0f);
+    std::vector<float> referenceData(static_cast<size_t>(size) * 2, 0.0f);
+    std::copy(signal.begin(), signal.end(), candidateData.begin());
+    std::copy(signal.begin(), signal.end(), referenceData.begin());
+
+    candidate->performRealOnlyForwardTransform(candidateData.data());
+    reference->performRealOnlyForwardTransform(referenceData.data());
+
+    float peak = 0.0f;
+    float spectrumError = 0.0f;
+    for (int i = 0; i < size + 2; ++i)
+    {
+        peak = std::max(peak, std::abs(referenceData[i]));
+        spectrumError = std::max(spectrumError, std::abs(candidateData[i] - referenceData[i]));
+    }
+
+    // Inverse of the reference spectrum must give back the signal
+    candidate->performRealOnlyInverseTransform(referenceData.data());
+
+    float signalError = 0.0f;
+    for (int i = 0; i < size; ++i)
+        signalError = std::max(signalError, std::abs(referenceData[i] - signal[static_cast<size_t>(i)]));
+
+    return std::max(spectrumError / std::max(peak, 1.0e-12f), signalError);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <memory>
+
+/**
+ * Real-input FFT engine behind all spectral analysis (STFT, and through it
+ * MelSpectrogram and FCPEPitchDetector).
+ *
+ * Two backends are available:
+ *  - Juce: juce::dsp::FFT (vDSP / IPP / FFTW when JUCE was built with them,
+ *    otherwise its scalar fallback).
+ *  - Simd: the bundled split-complex Stockham FFT using SSE2 / NEON.
+ *
+ * The default is chosen at build time (CMake PITCH_EDITOR_FFT_BACKEND) and can
+ * be overridden at run time with the PITCH_EDITOR_FFT_BACKEND environment
+ * variable or setDefaultType(). Both backends follow the JUCE real-only data
+ * layout, so callers never see which one is in use.
+ *
+ * An instance keeps its own work buffers and must only be used by one thread
+ * at a time.
+ */
+class FFTBackend
+{
+public:
+    enum class Type
+    {
+        Juce,
+        Simd
+    };
+
+    virtual ~FFTBackend() = default;
+
+    virtual Type getType() const = 0;
+    int getOrder() const { return order; }
+    int getSize() const { return size; }
+
+    /**
+     * In-place forward transform of getSize() real samples in data[0, size).
+     * data must hold 2 * getSize() floats; bins 0..size/2 are written as
+     * interleaved (re, im) pairs to data[0, size + 2). Later values are undefined.
+     */
+    virtual void performRealOnlyForwardTransform(float* data) = 0;
+
+    /**
+     * Inverse of performRealOnlyForwardTransform, including the 1 / size
+     * scaling. Reads bins 0..size/2 and writes getSize() real samples to
+     * data[0, size). data must hold 2 * getSize() floats.
+     */
+    virtual void performRealOnlyInverseTransform(float* data) = 0;
+
+    /** Create a transform of size 2^order (order >= 1). */
+    static std::unique_ptr<FFTBackend> create(int order, Type type);
+    static std::unique_ptr<FFTBackend> create(int order) { return create(order, getDefaultType()); }
+
+    static Type getDefaultType();
+    static void setDefaultType(Type type);
+
+    /** "juce" or "simd" */
+    static const char* getTypeName(Type type);
+    static bool parseTypeName(const juce::String& name, Type& type);
+
+    /**
+     * Run the same pseudo-random signal through the given backend and the JUCE
+     * backend, forward and inverse, and return the largest difference relative
+     * to the peak value. Debug builds check every new (backend, order) pair
+     * with this the first time it is created.
+     */
+    static float crossCheck(Type type, int order);
+
+    /** Largest crossCheck() result accepted as agreeing with JUCE. */
+    static constexpr float crossCheckTolerance = 1.0e-4f;
+
+protected:
+    explicit FFTBackend(int order) : order(order), size(1 << order) {}
+
+private:
+    static std::unique_ptr<FFTBackend> createUnchecked(int order, Type type);
+
+    int order;
+    int size;
+};
@@ -0,0 +1,60 @@
+#include "MelFilterbank.h"
+#include "SimdMath.h"
+
+MelFilterbank MelFilterbank::fromDense(const float* dense, int numMels, int numBins)
+{
+    MelFilterbank fb;
+    fb.numBins = numBins;
+    fb.bands.resize(numMels);
+
+    for (int m = 0; m < numMels; ++m)
+    {
+        const float* row = dense + static_cast<size_t>(m) * numBins;
+
+        int first = 0;
+        while (first < numBins && row[first] == 0.0f)
+            ++first;
+
+        int last = numBins - 1;
+        while (last >= first && row[last] == 0.0f)
+            --last;
+
+        Band& band = fb.bands[m];
+        band.firstBin = first < numBins ? first : 0;
+        band.numWeights = last >= first ? last - first + 1 : 0;
+        band.weightOffset = static_cast<int>(fb.weights.size());
+
+        fb.weights.insert(fb.weights.end(), row + band.firstBin, row + band.firstBin + band.numWeights);
+    }
+
+    return fb;
+}
+
+void MelFilterbank::apply(const float* magnitude, float* melOut) const
+{
+    const int numMels = getNumMels();
+    for (int m = 0; m < numMels; ++m)
+    {
+        const Band& band = bands[m];
+        const float* w = weights.data() + band.weightOffset;
+        const float* mag = magnitude + band.firstBin;
+
+        float sum = 0.0f;
+        for (int k = 0; k < band.numWeights; ++k)
+            sum += mag[k] * w[k];
+
+        melOut[m] = sum;
+    }
+}
+
+void MelFilterbank::applyBlock(const float* magnitudeT, int numFrames, float* melOutT) const
+{
+    const int numMels = getNumMels();
+    for (int m = 0; m < numMels; ++m)
+    {
+        const Band& band = bands[m];
+        SimdMath::multiplyAccumulateColumns(magnitudeT + static_cast<size_t>(band.firstBin) * numFrames, numFrames,
+                                            weights.data() + band.weightOffset, band.numWeights,
+                                            melOutT + static_cast<size_t>(m) * numFrames, numFrames);
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * Sparse mel filterbank.
+ *
+ * Each triangular filter is non-zero on only a handful of FFT bins, so every
+ * band is stored as (firstBin, weights[]) covering just its non-zero span.
+ * Projection then costs O(total span) instead of O(numMels * numBins).
+ */
+class MelFilterbank
+{
+public:
+    struct Band
+    {
+        int firstBin = 0;
+        int numWeights = 0;
+        int weightOffset = 0;  // Index into the shared weight array
+    };
+
+    MelFilterbank() = default;
+
+    /**
+     * Build from a dense row-major [numMels x numBins] matrix,
+     * keeping only the span between the first and last non-zero bin of each row.
+     */
+    static MelFilterbank fromDense(const float* dense, int numMels, int numBins);
+
+    bool isEmpty() const { return bands.empty(); }
+    int getNumMels() const { return static_cast<int>(bands.size()); }
+    int getNumBins() const { return numBins; }
+
+    const Band& getBand(int m) const { return bands[m]; }
+    const float* getWeights(int m) const { return weights.data() + bands[m].weightOffset; }
+
+    /** Total number of stored (non-zero span) weights. */
+    int getNumStoredWeights() const { return static_cast<int>(weights.size()); }
+
+    /**
+     * Project one magnitude spectrum [numBins] onto all bands [numMels].
+     * Summation order matches the dense dot product, so results are identical.
+     */
+    void apply(const float* magnitude, float* melOut) const;
+
+    /**
+     * Batched projection of a block of frames, computed as a small GEMM.
+     * @param magnitudeT Bin-major magnitudes [numBins x numFrames]
+     * @param numFrames  Frames in the block (columns)
+     * @param melOutT    Mel-major output [numMels x numFrames]
+     * Every frame is summed in the same order as apply(), so results are identical.
+     */
+    void applyBlock(const float* magnitudeT, int numFrames, float* melOutT) const;
+
+private:
+    int numBins = 0;
+    std::vector<Band> bands;
+    std::vector<float> weights;
+};
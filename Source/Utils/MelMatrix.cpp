@@ -0,0 +1,181 @@
+#include "MelMatrix.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace
+{
+    // Tile size for blocked transposes (keeps both sides within L1)
+    constexpr int transposeTile = 32;
+
+    void transposeBlocked(const float* src, int srcRows, int srcCols, int srcStride,
+                          float* dst, int dstStride)
+    {
+        for (int r0 = 0; r0 < srcRows; r0 += transposeTile)
+        {
+            const int r1 = std::min(srcRows, r0 + transposeTile);
+            for (int c0 = 0; c0 < srcCols; c0 += transposeTile)
+            {
+                const int c1 = std::min(srcCols, c0 + transposeTile);
+                for (int r = r0; r < r1; ++r)
+                {
+                    const float* srcRow = src + static_cast<size_t>(r) * srcStride;
+                    for (int c = c0; c < c1; ++c)
+                        dst[static_cast<size_t>(c) * dstStride + r] = srcRow[c];
+                }
+            }
+        }
+    }
+}
+
+MelMatrix::MelMatrix(int numFrames, int numMels, Layout layout)
+{
+    resize(numFrames, numMels, layout);
+}
+
+void MelMatrix::resize(int newNumFrames, int newNumMels, Layout newLayout)
+{
+    numFrames = std::max(0, newNumFrames);
+    numMels = std::max(0, newNumMels);
+    layout = newLayout;
+    values.assign(static_cast<size_t>(numFrames) * numMels, 0.0f);
+}
+
+void MelMatrix::clear()
+{
+    numFrames = 0;
+    numMels = 0;
+    values.clear();
+    values.shrink_to_fit();
+}
+
+void MelMatrix::setNumFrames(int newNumFrames)
+{
+    newNumFrames = std::max(0, newNumFrames);
+    if (newNumFrames == numFrames)
+        return;
+
+    if (layout == Layout::FrameMajor)
+    {
+        values.resize(static_cast<size_t>(newNumFrames) * numMels, 0.0f);
+    }
+    else
+    {
+        // Band rows change stride, so rebuild them
+        std::vector<float> resized(static_cast<size_t>(newNumFrames) * numMels, 0.0f);
+        const int keep = std::min(numFrames, newNumFrames);
+        for (int m = 0; m < numMels; ++m)
+            std::memcpy(resized.data() + static_cast<size_t>(m) * newNumFrames,
+                        values.data() + static_cast<size_t>(m) * numFrames,
+                        sizeof(float) * static_cast<size_t>(keep));
+        values = std::move(resized);
+    }
+
+    numFrames = newNumFrames;
+}
+
+MelMatrix::Slice<float> MelMatrix::frame(int t)
+{
+    if (layout == Layout::FrameMajor)
+        return { values.data() + static_cast<size_t>(t) * numMels, numMels, 1 };
+    return { values.data() + t, numMels, numFrames };
+}
+
+MelMatrix::Slice<const float> MelMatrix::frame(int t) const
+{
+    if (layout == Layout::FrameMajor)
+        return { values.data() + static_cast<size_t>(t) * numMels, numMels, 1 };
+    return { values.data() + t, numMels, numFrames };
+}
+
+MelMatrix::Slice<float> MelMatrix::band(int m)
+{
+    if (layout == Layout::MelMajor)
+        return { values.data() + static_cast<size_t>(m) * numFrames, numFrames, 1 };
+    return { values.data() + m, numFrames, numMels };
+}
+
+MelMatrix::Slice<const float> MelMatrix::band(int m) const
+{
+    if (layout == Layout::MelMajor)
+        return { values.data() + static_cast<size_t>(m) * numFrames, numFrames, 1 };
+    return { values.data() + m, numFrames, numMels };
+}
+
+void MelMatrix::copyFramesTo(int startFrame, int count, float* dest, Layout destLayout) const
+{
+    if (count <= 0 || numMels == 0)
+        return;
+
+    if (layout == Layout::FrameMajor)
+    {
+        const float* src = values.data() + static_cast<size_t>(startFrame) * numMels;
+
+        if (destLayout == Layout::FrameMajor)
+            std::memcpy(dest, src, sizeof(float) * static_cast<size_t>(count) * numMels);
+        else
+            transposeBlocked(src, count, numMels, numMels, dest, count);
+    }
+    else
+    {
+        const float* src = values.data() + startFrame;
+
+        if (destLayout == Layout::MelMajor)
+        {
+            for (int m = 0; m < numMels; ++m)
+                std::memcpy(dest + static_cast<size_t>(m) * count,
+                            src + static_cast<size_t>(m) * numFrames,
+                            sizeof(float) * static_cast<size_t>(count));
+        }
+        else
+        {
+            transposeBlocked(src, numMels, count, numFrames, dest, numMels);
+        }
+    }
+}
+
+void MelMatrix::setFrames(int startFrame, int count, const float* src, Layout srcLayout)
+{
+    if (count <= 0 || numMels == 0)
+        return;
+
+    if (layout == Layout::FrameMajor)
+    {
+        float* dest = values.data() + static_cast<size_t>(startFrame) * numMels;
+
+        if (srcLayout == Layout::FrameMajor)
+            std::memcpy(dest, src, sizeof(float) * static_cast<size_t>(count) * numMels);
+        else
+            transposeBlocked(src, numMels, count, count, dest, numMels);
+    }
+    else
+    {
+        float* dest = values.data() + startFrame;
+
+        if (srcLayout == Layout::MelMajor)
+        {
+            for (int m = 0; m < numMels; ++m)
+                std::memcpy(dest + static_cast<size_t>(m) * numFrames,
+                            src + static_cast<size_t>(m) * count,
+                            sizeof(float) * static_cast<size_t>(count));
+        }
+        else
+        {
+            transposeBlocked(src, count, numMels, numMels, dest, numFrames);
+        }
+    }
+}
+
+MelMatrix MelMatrix::sliceFrames(int startFrame, int endFrame, Layout destLayout) const
+{
+    startFrame = std::max(0, startFrame);
+    endFrame = std::min(endFrame, numFrames);
+
+    MelMatrix result;
+    if (startFrame >= endFrame)
+        return result;
+
+    result.resize(endFrame - startFrame, numMels, destLayout);
+    copyFramesTo(startFrame, endFrame - startFrame, result.data(), destLayout);
+    return result;
+}
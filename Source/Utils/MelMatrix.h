@@ -0,0 +1,108 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * Contiguous mel spectrogram storage.
+ *
+ * All numFrames x numMels values live in one allocation. The layout decides
+ * which axis is contiguous:
+ *   - FrameMajor: [T, numMels], one frame per row (FCPE input layout)
+ *   - MelMajor:   [numMels, T], one mel band per row (vocoder input layout)
+ * so each consumer can hand data() to ONNX Runtime without reshaping.
+ */
+class MelMatrix
+{
+public:
+    enum class Layout
+    {
+        FrameMajor,
+        MelMajor
+    };
+
+    /**
+     * Lightweight strided view over one frame or one mel band.
+     * Valid until the owning matrix is resized or destroyed.
+     */
+    template <typename T>
+    struct Slice
+    {
+        T* values = nullptr;
+        int size = 0;
+        std::ptrdiff_t stride = 1;
+
+        T& operator[](int i) const { return values[i * stride]; }
+        bool isContiguous() const { return stride == 1; }
+    };
+
+    MelMatrix() = default;
+    MelMatrix(int numFrames, int numMels, Layout layout = Layout::FrameMajor);
+
+    /**
+     * Reshape and zero. Existing values are not preserved; the storage is
+     * only reallocated when it has to grow.
+     */
+    void resize(int numFrames, int numMels, Layout layout);
+    void clear();
+
+    /**
+     * Change the number of frames, keeping the first min(old, new) frames.
+     * Added frames are zero.
+     */
+    void setNumFrames(int newNumFrames);
+
+    bool empty() const { return numFrames == 0 || numMels == 0; }
+    int getNumFrames() const { return numFrames; }
+    int getNumMels() const { return numMels; }
+    Layout getLayout() const { return layout; }
+
+    float* data() { return values.data(); }
+    const float* data() const { return values.data(); }
+    size_t size() const { return values.size(); }
+
+    float& at(int frame, int mel) { return values[index(frame, mel)]; }
+    float at(int frame, int mel) const { return values[index(frame, mel)]; }
+
+    // Row/column views
+    Slice<float> frame(int t);
+    Slice<const float> frame(int t) const;
+    Slice<float> band(int m);
+    Slice<const float> band(int m) const;
+
+    /**
+     * Copy a range of frames into a flat destination buffer in the requested
+     * layout. The destination must hold count * numMels floats.
+     */
+    void copyFramesTo(int startFrame, int count, float* dest, Layout destLayout) const;
+
+    /**
+     * Inverse of copyFramesTo: overwrite frames [startFrame, startFrame + count)
+     * from a flat source buffer of count * numMels floats in srcLayout.
+     */
+    void setFrames(int startFrame, int count, const float* src, Layout srcLayout);
+
+    /**
+     * Copy of frames [startFrame, endFrame) in the given layout.
+     */
+    MelMatrix sliceFrames(int startFrame, int endFrame, Layout destLayout) const;
+    MelMatrix sliceFrames(int startFrame, int endFrame) const { return sliceFrames(startFrame, endFrame, layout); }
+
+    /**
+     * Copy of the whole matrix in the given layout.
+     */
+    MelMatrix withLayout(Layout destLayout) const { return sliceFrames(0, numFrames, destLayout); }
+
+private:
+    size_t index(int frame, int mel) const
+    {
+        return layout == Layout::FrameMajor
+            ? static_cast<size_t>(frame) * numMels + mel
+            : static_cast<size_t>(mel) * numFrames + frame;
+    }
+
+    int numFrames = 0;
+    int numMels = 0;
+    Layout layout = Layout::FrameMajor;
+    std::vector<float> values;
+};
@@ -1,24 +1,44 @@
 #include "MelSpectrogram.h"
+#include "WorkerPool.h"
+#include "SimdMath.h"
 #include <cmath>
 #include <algorithm>
 
-MelSpectrogram::MelSpectrogram(int sampleRate, int nFft, int hopSize,
-                               int numMels, float fMin, float fMax)
-    : sampleRate(sampleRate), nFft(nFft), hopSize(hopSize),
-      numMels(numMels), fMin(fMin), fMax(fMax),
-      fft(static_cast<int>(std::log2(nFft)))
+namespace
 {
-    // Create Hann window (periodic, matches librosa default)
-    window.resize(nFft);
-    for (int i = 0; i < nFft; ++i)
+    STFT::Config makeVocoderSTFTConfig(int sampleRate, int nFft, int hopSize)
     {
-        window[i] = 0.5f * (1.0f - std::cos(2.0f * juce::MathConstants<float>::pi * i / nFft));
+        STFT::Config config;
+        config.sampleRate = sampleRate;
+        config.nFft = nFft;
+        config.winSize = nFft;
+        config.hopSize = hopSize;
+        config.window = STFT::WindowType::HannPeriodic;  // Matches librosa default
+        config.padding = STFT::PaddingMode::Zero;
+        config.centering = STFT::Centering::None;
+        return config;
     }
-    
-    createMelFilterbank();
 }
 
-void MelSpectrogram::createMelFilterbank()
+MelSpectrogram::MelSpectrogram(int sampleRate, int nFft, int hopSize,
+                               int numMels, float fMin, float fMax)
+    : MelSpectrogram(makeVocoderSTFTConfig(sampleRate, nFft, hopSize),
+                     createSlaneyFilterbank(sampleRate, nFft, numMels, fMin, fMax),
+                     0.0f, 1e-5f)
+{
+}
+
+MelSpectrogram::MelSpectrogram(const STFT::Config& stftConfig, MelFilterbank filterbank,
+                               float magnitudeEpsilon, float logFloor)
+    : stft(stftConfig),
+      melFilterbank(std::move(filterbank)),
+      numMels(melFilterbank.getNumMels()),
+      magnitudeEpsilon(magnitudeEpsilon),
+      logFloor(logFloor)
+{
+}
+
+MelFilterbank MelSpectrogram::createSlaneyFilterbank(int sampleRate, int nFft, int numMels, float fMin, float fMax)
 {
     // Slaney-style mel scale (matches librosa default with htk=False)
     // This is a piecewise linear (below 1000Hz) / log (above 1000Hz) scale
@@ -71,10 +91,10 @@ void MelSpectrogram::createMelFilterbank()
     }
     
     // Create filterbank with Slaney normalization (area normalization)
-    melFilterbank.resize(numMels);
+    std::vector<float> dense(static_cast<size_t>(numMels) * numBins, 0.0f);
     for (int m = 0; m < numMels; ++m)
     {
-        melFilterbank[m].resize(numBins, 0.0f);
+        float* row = dense.data() + static_cast<size_t>(m) * numBins;
         
         float fLow = hzPoints[m];
         float fCenter = hzPoints[m + 1];
@@ -90,67 +110,207 @@ void MelSpectrogram::createMelFilterbank()
             if (freq >= fLow && freq < fCenter)
             {
                 // Rising edge
-                melFilterbank[m][k] = enorm * (freq - fLow) / (fCenter - fLow);
+                row[k] = enorm * (freq - fLow) / (fCenter - fLow);
             }
             else if (freq >= fCenter && freq <= fHigh)
             {
                 // Falling edge
-                melFilterbank[m][k] = enorm * (fHigh - freq) / (fHigh - fCenter);
+                row[k] = enorm * (fHigh - freq) / (fHigh - fCenter);
             }
         }
     }
+    
+    // Keep only the non-zero span of each triangle
+    return MelFilterbank::fromDense(dense.data(), numMels, numBins);
+}
+
+MelMatrix MelSpectrogram::compute(const float* audio, int numSamples, MelMatrix::Layout layout)
+{
+    const int numFrames = getNumFrames(numSamples);
+    
+    MelMatrix mel(numFrames, numMels, layout);
+    computeFramesParallel(audio, numSamples, 0, numFrames, mel);
+    return mel;
 }
 
-std::vector<std::vector<float>> MelSpectrogram::compute(const float* audio, int numSamples)
+std::pair<int, int> MelSpectrogram::computeRange(const float* audio, int numSamples,
+                                                 int startSample, int endSample, MelMatrix& mel)
 {
-    int numFrames = (numSamples - nFft) / hopSize + 1;
-    if (numFrames < 1)
+    const int numFrames = getNumFrames(numSamples);
+    
+    if (mel.empty() || mel.getNumMels() != numMels)
     {
-        numFrames = 1;
+        mel = compute(audio, numSamples, mel.getLayout());
+        return {0, numFrames};
     }
     
-    std::vector<std::vector<float>> mel(numFrames);
-    int numBins = nFft / 2 + 1;
+    auto [startFrame, endFrame] = stft.getAffectedFrames(numSamples, startSample, endSample);
     
-    std::vector<float> frame(nFft * 2, 0.0f);  // Complex FFT buffer
+    if (numFrames != mel.getNumFrames())
+    {
+        // Frames past the old end have nothing to keep
+        startFrame = std::min(startFrame, mel.getNumFrames());
+        mel.setNumFrames(numFrames);
+    }
     
-    for (int i = 0; i < numFrames; ++i)
+    if (startFrame < endFrame)
+        computeFramesParallel(audio, numSamples, startFrame, endFrame, mel);
+    
+    return {startFrame, endFrame};
+}
+
+MelMatrix MelSpectrogram::computeFrameRange(const float* audio, int numSamples, int startFrame, int endFrame,
+                                            MelMatrix::Layout layout)
+{
+    MelMatrix mel(0, numMels, layout);
+    computeFrameRange(audio, numSamples, startFrame, endFrame, mel);
+    return mel;
+}
+
+void MelSpectrogram::computeFrameRange(const float* audio, int numSamples, int startFrame, int endFrame,
+                                       MelMatrix& mel)
+{
+    startFrame = std::max(0, startFrame);
+    endFrame = std::min(endFrame, getNumFrames(numSamples));
+    
+    mel.resize(std::max(0, endFrame - startFrame), numMels, mel.getLayout());
+    if (startFrame >= endFrame)
+        return;
+    
+    computeFramesParallel(audio, numSamples, startFrame, endFrame, mel, startFrame);
+}
+
+void MelSpectrogram::computeFramesParallel(const float* audio, int numSamples, int startFrame, int endFrame,
+                                           MelMatrix& mel, int melOffset)
+{
+    const int numBlocks = (endFrame - startFrame + framesPerBlock - 1) / framesPerBlock;
+    
+    if (!multithreaded || numBlocks <= 1)
     {
-        int startSample = i * hopSize;
-        
-        // Copy and window
-        std::fill(frame.begin(), frame.end(), 0.0f);
-        for (int j = 0; j < nFft && startSample + j < numSamples; ++j)
-        {
-            frame[j] = audio[startSample + j] * window[j];
-        }
+        Scratch scratch;
+        prepareScratch(scratch);
+        computeFrames(audio, numSamples, startFrame, endFrame, mel, scratch, melOffset);
+        return;
+    }
+    
+    // Each block writes a disjoint frame range, so workers never share output
+    auto& pool = WorkerPool::getInstance();
+    std::vector<Scratch> scratch(static_cast<size_t>(pool.getMaxConcurrency()));
+    
+    pool.parallelFor(numBlocks, [&](int block, int worker)
+    {
+        auto& workerScratch = scratch[static_cast<size_t>(worker)];
+        if (!workerScratch.stft.isPrepared())
+            prepareScratch(workerScratch);
         
-        // Perform FFT
-        fft.performRealOnlyForwardTransform(frame.data());
+        const int start = startFrame + block * framesPerBlock;
+        const int end = std::min(endFrame, start + framesPerBlock);
+        computeFrames(audio, numSamples, start, end, mel, workerScratch, melOffset);
+    });
+}
+
+void MelSpectrogram::resetStream()
+{
+    // Frame boundaries of a centred STFT depend on the end of the signal
+    jassert(stft.getConfig().centering == STFT::Centering::None);
+    
+    if (!streamScratch.stft.isPrepared())
+        prepareScratch(streamScratch);
+    
+    const int winSize = stft.getConfig().winSize;
+    streamRing.assign(static_cast<size_t>(winSize), 0.0f);
+    streamWindow.assign(static_cast<size_t>(winSize), 0.0f);
+    streamFrame.resize(1, numMels, MelMatrix::Layout::FrameMajor);
+    streamWritePos = 0;
+    streamSamples = 0;
+    streamNextFrameEnd = winSize;
+    streamFramesEmitted = 0;
+}
+
+int MelSpectrogram::pushSamples(const float* samples, int numSamples, const FrameCallback& onFrame)
+{
+    if (streamRing.empty())
+        resetStream();
+    
+    const int winSize = stft.getConfig().winSize;
+    const int hopSize = stft.getConfig().hopSize;
+    int emitted = 0;
+    
+    while (numSamples > 0)
+    {
+        // Copy up to the end of the next window (or of the ring)
+        const int untilFrame = static_cast<int>(std::min<int64_t>(streamNextFrameEnd - streamSamples, numSamples));
+        const int chunk = std::min(untilFrame, winSize - streamWritePos);
         
-        // Compute magnitude spectrum
-        std::vector<float> mag(numBins);
-        for (int k = 0; k < numBins; ++k)
-        {
-            float real = frame[k * 2];
-            float imag = frame[k * 2 + 1];
-            mag[k] = std::sqrt(real * real + imag * imag);
-        }
+        std::copy(samples, samples + chunk, streamRing.begin() + streamWritePos);
+        streamWritePos = (streamWritePos + chunk) % winSize;
+        streamSamples += chunk;
+        samples += chunk;
+        numSamples -= chunk;
         
-        // Apply mel filterbank
-        mel[i].resize(numMels);
-        for (int m = 0; m < numMels; ++m)
+        if (streamSamples == streamNextFrameEnd)
         {
-            float sum = 0.0f;
-            for (int k = 0; k < numBins; ++k)
-            {
-                sum += mag[k] * melFilterbank[m][k];
-            }
-            
-            // Log scale (natural log for vocoder compatibility)
-            mel[i][m] = std::log(std::max(sum, 1e-5f));
+            emitStreamFrame(onFrame);
+            streamNextFrameEnd += hopSize;
+            ++emitted;
         }
     }
     
-    return mel;
+    return emitted;
+}
+
+int MelSpectrogram::finishStream(const FrameCallback& onFrame)
+{
+    if (streamRing.empty())
+        resetStream();
+    
+    if (streamFramesEmitted > 0)
+        return 0;
+    
+    // Shorter than one window: compute() zero-pads a single frame
+    const int available = static_cast<int>(streamSamples);
+    std::fill(streamWindow.begin(), streamWindow.end(), 0.0f);
+    std::copy(streamRing.begin(), streamRing.begin() + available, streamWindow.begin());
+    
+    computeFrames(streamWindow.data(), available, 0, 1, streamFrame, streamScratch);
+    onFrame(streamFramesEmitted++, streamFrame.data());
+    return 1;
+}
+
+void MelSpectrogram::emitStreamFrame(const FrameCallback& onFrame)
+{
+    // The ring holds exactly the window; the oldest sample sits at the write position
+    const int winSize = stft.getConfig().winSize;
+    const int tail = winSize - streamWritePos;
+    std::copy(streamRing.begin() + streamWritePos, streamRing.end(), streamWindow.begin());
+    std::copy(streamRing.begin(), streamRing.begin() + streamWritePos, streamWindow.begin() + tail);
+    
+    computeFrames(streamWindow.data(), winSize, 0, 1, streamFrame, streamScratch);
+    onFrame(streamFramesEmitted++, streamFrame.data());
+}
+
+void MelSpectrogram::prepareScratch(Scratch& scratch) const
+{
+    stft.prepareWorkspace(scratch.stft);
+    scratch.magnitudeT.assign(static_cast<size_t>(stft.getNumBins()) * kernelFrames, 0.0f);
+    scratch.melT.assign(static_cast<size_t>(numMels) * kernelFrames, 0.0f);
+}
+
+void MelSpectrogram::computeFrames(const float* audio, int numSamples, int startFrame, int endFrame,
+                                   MelMatrix& mel, Scratch& scratch, int melOffset) const
+{
+    for (int blockStart = startFrame; blockStart < endFrame; blockStart += kernelFrames)
+    {
+        const int blockSize = std::min(kernelFrames, endFrame - blockStart);
+        
+        // Windowed FFT magnitudes for the block, bin-major
+        stft.computeMagnitudes(audio, numSamples, blockStart, blockSize,
+                               scratch.magnitudeT.data(), magnitudeEpsilon, scratch.stft);
+        
+        // Mel projection for the whole block, then log scale (natural log for vocoder compatibility)
+        melFilterbank.applyBlock(scratch.magnitudeT.data(), blockSize, scratch.melT.data());
+        SimdMath::logClamped(scratch.melT.data(), numMels * blockSize, logFloor);
+        
+        mel.setFrames(blockStart - melOffset, blockSize, scratch.melT.data(), MelMatrix::Layout::MelMajor);
+    }
 }
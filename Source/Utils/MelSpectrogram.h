@@ -1,40 +1,166 @@
 #pragma once
 
 #include "../JuceHeader.h"
+#include "MelMatrix.h"
+#include "MelFilterbank.h"
+#include "STFT.h"
 #include <vector>
+#include <memory>
+#include <utility>
+#include <functional>
+#include <cstdint>
 
 /**
- * Mel spectrogram computation.
+ * Mel spectrogram computation on top of the shared STFT engine.
+ * Frames are processed in blocks on the shared WorkerPool; every worker has
+ * its own FFT and scratch, so the result is identical to the serial path.
+ * Within a block, frames go through the SIMD kernels in SimdMath.h in groups
+ * of kernelFrames; the output is within 2e-6 (log domain) of a scalar std::log loop.
+ * pushSamples() offers the same analysis as a stream, frame by frame.
  */
 class MelSpectrogram
 {
 public:
+    /**
+     * Vocoder front-end: periodic Hann, no centering, Slaney mel bands,
+     * log clamped at 1e-5.
+     */
     MelSpectrogram(int sampleRate = 44100, int nFft = 2048, int hopSize = 512,
                    int numMels = 128, float fMin = 40.0f, float fMax = 16000.0f);
+    
+    /**
+     * Custom front-end (e.g. FCPE).
+     * @param stftConfig Framing, window and padding
+     * @param filterbank Mel bands over stftConfig.nFft / 2 + 1 bins
+     * @param magnitudeEpsilon Added to |X|^2 before the square root
+     * @param logFloor Values are clamped to this before the log
+     */
+    MelSpectrogram(const STFT::Config& stftConfig, MelFilterbank filterbank,
+                   float magnitudeEpsilon, float logFloor);
     ~MelSpectrogram() = default;
     
+    /**
+     * Slaney-style mel filterbank (librosa default, htk=False).
+     */
+    static MelFilterbank createSlaneyFilterbank(int sampleRate, int nFft, int numMels, float fMin, float fMax);
+    
+    const STFT& getSTFT() const { return stft; }
+    int getNumMels() const { return numMels; }
+    
+    /** Number of frames compute() returns for numSamples. */
+    int getNumFrames(int numSamples) const { return stft.getNumFrames(numSamples); }
+    
     /**
      * Compute mel spectrogram from audio.
      * @param audio Audio samples
      * @param numSamples Number of samples
-     * @return Mel spectrogram [T, numMels] in log scale
+     * @param layout Storage layout of the result
+     * @return Mel spectrogram (T frames x numMels) in log scale
+     */
+    MelMatrix compute(const float* audio, int numSamples,
+                      MelMatrix::Layout layout = MelMatrix::Layout::FrameMajor);
+    
+    /**
+     * Recompute only the frames whose analysis windows overlap the changed
+     * samples [startSample, endSample) and patch them into mel, which must
+     * hold the spectrogram of the audio before the edit.
+     * For edits that change the length (trim, insert) pass endSample =
+     * numSamples, since every later window has moved; mel is resized to the
+     * new frame count keeping the frames before the edit.
+     * Falls back to a full compute when mel is empty or has another band count.
+     * @param audio Full audio after the edit
+     * @param numSamples Number of samples after the edit
+     * @return Recomputed frame range {start, end}
+     */
+    std::pair<int, int> computeRange(const float* audio, int numSamples,
+                                     int startSample, int endSample, MelMatrix& mel);
+    
+    /**
+     * Frames [startFrame, endFrame) of compute(audio, numSamples), without
+     * computing the rest (e.g. to process a long file in bounded memory).
+     */
+    MelMatrix computeFrameRange(const float* audio, int numSamples, int startFrame, int endFrame,
+                                MelMatrix::Layout layout = MelMatrix::Layout::FrameMajor);
+    
+    /**
+     * As above, into mel (keeping its layout), so a caller analysing many
+     * ranges can reuse one allocation. mel is empty if the range is.
      */
-    std::vector<std::vector<float>> compute(const float* audio, int numSamples);
+    void computeFrameRange(const float* audio, int numSamples, int startFrame, int endFrame,
+                           MelMatrix& mel);
+    
+    /** Receives one streamed frame: numMels log-mel values. */
+    using FrameCallback = std::function<void(int frameIndex, const float* melFrame)>;
+    
+    /**
+     * Start a new stream (also allocates the streaming buffers).
+     * Streaming needs an uncentred STFT (STFT::Centering::None).
+     * Streaming and compute() may be used on the same object, but not concurrently.
+     */
+    void resetStream();
+    
+    /**
+     * Push an arbitrary-sized block of samples. Each frame is emitted as soon
+     * as its window is complete, with the same frame boundaries and values as
+     * compute() on the concatenated input. Does not allocate.
+     * @return Number of frames emitted
+     */
+    int pushSamples(const float* samples, int numSamples, const FrameCallback& onFrame);
+    
+    /**
+     * End of stream. compute() always returns at least one (zero-padded)
+     * frame; if the stream was shorter than one window this emits it.
+     * @return Number of frames emitted
+     */
+    int finishStream(const FrameCallback& onFrame);
+    
+    /** Frames emitted since resetStream(). */
+    int getNumStreamedFrames() const { return streamFramesEmitted; }
+    
+    /**
+     * Enable/disable block-parallel computation (enabled by default).
+     */
+    void setMultithreaded(bool shouldUseWorkerPool) { multithreaded = shouldUseWorkerPool; }
     
 private:
-    void createMelFilterbank();
-    void applyWindow(std::vector<float>& frame);
-    std::vector<float> computeFFT(const std::vector<float>& frame);
+    // Frames handed to a worker at a time
+    static constexpr int framesPerBlock = 64;
     
-    int sampleRate;
-    int nFft;
-    int hopSize;
+    // Frames projected together by the batched mel kernel
+    static constexpr int kernelFrames = 8;
+    
+    // Per-worker STFT workspace and kernel buffers
+    struct Scratch
+    {
+        STFT::Workspace stft;
+        std::vector<float> magnitudeT;  // Bin-major block [(nFft/2 + 1) x kernelFrames]
+        std::vector<float> melT;        // Mel-major block [numMels x kernelFrames]
+    };
+    
+    // Frame f is written to row f - melOffset of mel
+    void computeFramesParallel(const float* audio, int numSamples, int startFrame, int endFrame,
+                               MelMatrix& mel, int melOffset = 0);
+    void prepareScratch(Scratch& scratch) const;
+    void computeFrames(const float* audio, int numSamples, int startFrame, int endFrame,
+                       MelMatrix& mel, Scratch& scratch, int melOffset = 0) const;
+    
+    STFT stft;
+    MelFilterbank melFilterbank;  // Sparse [numMels x (nFft/2+1)]
     int numMels;
-    float fMin;
-    float fMax;
+    float magnitudeEpsilon;
+    float logFloor;
+    
+    bool multithreaded = true;
     
-    std::vector<float> window;  // Hann window
-    std::vector<std::vector<float>> melFilterbank;
+    // Streaming state
+    void emitStreamFrame(const FrameCallback& onFrame);
     
-    juce::dsp::FFT fft;
+    Scratch streamScratch;
+    std::vector<float> streamRing;      // Last winSize samples
+    std::vector<float> streamWindow;    // Ring unrolled into one window
+    MelMatrix streamFrame;              // Single-frame output
+    int streamWritePos = 0;
+    int64_t streamSamples = 0;
+    int64_t streamNextFrameEnd = 0;     // Sample count at which the next window is complete
+    int streamFramesEmitted = 0;
 };
@@ -0,0 +1,285 @@
+#include "Resampler.h"
+#include "SimdMath.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numeric>
+
+namespace
+{
+    // Filter design: sinc zero crossings on each side (at the lower rate),
+    // Kaiser beta (~85 dB stopband) and cutoff relative to the lower Nyquist
+    constexpr int zeroCrossings = 32;
+    constexpr double kaiserBeta = 8.5;
+    constexpr double rolloff = 0.94;
+
+    // Ratios needing more phases are approximated (the rate error stays below 1e-6)
+    constexpr int maxPhases = 1024;
+
+    // Input samples buffered per streaming refill
+    constexpr int streamBlockSize = 4096;
+
+    double besselI0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 64 && term > sum * 1e-17; ++k)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    /** up / down as a fraction target / source with up <= maxPhases. */
+    std::pair<int, int> getRatio(int sourceRate, int targetRate)
+    {
+        const int divisor = std::gcd(sourceRate, targetRate);
+        int up = targetRate / divisor;
+        int down = sourceRate / divisor;
+
+        if (up <= maxPhases)
+            return { up, down };
+
+        // Last continued-fraction convergent whose numerator still fits
+        const double ratio = static_cast<double>(targetRate) / sourceRate;
+        long long h0 = 0, h1 = 1, k0 = 1, k1 = 0;
+        double x = ratio;
+        for (int i = 0; i < 32; ++i)
+        {
+            const long long a = static_cast<long long>(std::floor(x));
+            const long long h2 = a * h1 + h0;
+            const long long k2 = a * k1 + k0;
+            if (h2 > maxPhases)
+                break;
+
+            h0 = h1; h1 = h2;
+            k0 = k1; k1 = k2;
+
+            const double remainder = x - static_cast<double>(a);
+            if (remainder < 1e-12)
+                break;
+            x = 1.0 / remainder;
+        }
+
+        return { static_cast<int>(std::max(1LL, h1)), static_cast<int>(std::max(1LL, k1)) };
+    }
+}
+
+//==============================================================================
+struct Resampler::Table
+{
+    int up = 1;
+    int down = 1;
+    int halfTaps = 0;
+    int numTaps = 0;
+    std::vector<float> coefficients;   // [up][numTaps], phase p at p * numTaps
+
+    const float* getPhase(int phase) const { return coefficients.data() + static_cast<size_t>(phase) * numTaps; }
+    bool isBypass() const { return up == down; }
+};
+
+std::shared_ptr<const Resampler::Table> Resampler::getTable(int upFactor, int downFactor)
+{
+    static std::mutex mutex;
+    static std::map<std::pair<int, int>, std::shared_ptr<const Table>> tables;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& cached = tables[{ upFactor, downFactor }];
+    if (cached != nullptr)
+        return cached;
+
+    auto table = std::make_shared<Table>();
+    table->up = upFactor;
+    table->down = downFactor;
+
+    if (upFactor != downFactor)
+    {
+        // Cutoff in cycles per input sample
+        const double cutoff = 0.5 * std::min(1.0, static_cast<double>(upFactor) / downFactor) * rolloff;
+
+        // Half length in input samples, even so the tap count is a multiple of 4
+        int halfTaps = static_cast<int>(std::ceil(zeroCrossings / (2.0 * cutoff)));
+        halfTaps += halfTaps % 2;
+
+        table->halfTaps = halfTaps;
+        table->numTaps = 2 * halfTaps;
+        table->coefficients.resize(static_cast<size_t>(upFactor) * table->numTaps);
+
+        const double windowNorm = besselI0(kaiserBeta);
+
+        for (int phase = 0; phase < upFactor; ++phase)
+        {
+            float* coeffs = table->coefficients.data() + static_cast<size_t>(phase) * table->numTaps;
+            double sum = 0.0;
+
+            // Tap m multiplies input sample (i - halfTaps + 1 + m) for output time i + phase / up
+            std::vector<double> values(static_cast<size_t>(table->numTaps));
+            for (int m = 0; m < table->numTaps; ++m)
+            {
+                const double t = static_cast<double>(phase) / upFactor + halfTaps - 1 - m;
+                const double x = 2.0 * cutoff * t;
+                const double sinc = std::abs(x) < 1e-12 ? 1.0
+                                                        : std::sin(juce::MathConstants<double>::pi * x)
+                                                              / (juce::MathConstants<double>::pi * x);
+                const double r = t / halfTaps;
+                const double window = std::abs(r) >= 1.0 ? 0.0 : besselI0(kaiserBeta * std::sqrt(1.0 - r * r)) / windowNorm;
+
+                values[static_cast<size_t>(m)] = 2.0 * cutoff * sinc * window;
+                sum += values[static_cast<size_t>(m)];
+            }
+
+            // Unity gain at DC for every phase
+            for (int m = 0; m < table->numTaps; ++m)
+                coeffs[m] = static_cast<float>(values[static_cast<size_t>(m)] / sum);
+        }
+    }
+
+    cached = table;
+    return cached;
+}
+
+//==============================================================================
+Resampler::Resampler(int sourceRate, int targetRate)
+    : sourceRate(std::max(1, sourceRate)),
+      targetRate(std::max(1, targetRate))
+{
+    const auto [up, down] = getRatio(this->sourceRate, this->targetRate);
+    table = getTable(up, down);
+
+    streamBuffer.resize(static_cast<size_t>(table->numTaps + streamBlockSize));
+    reset();
+}
+
+int Resampler::getOutputLength(int numInput) const
+{
+    return static_cast<int>(static_cast<int64_t>(numInput) * targetRate / sourceRate);
+}
+
+int Resampler::getLookahead() const
+{
+    return table->halfTaps;
+}
+
+float Resampler::computeSample(const float* input, int numInput, int64_t inputIndex, int phase, float* padded) const
+{
+    const int numTaps = table->numTaps;
+    const int64_t first = inputIndex - table->halfTaps + 1;
+
+    if (first >= 0 && first + numTaps <= numInput)
+        return SimdMath::dotProduct(table->getPhase(phase), input + first, numTaps);
+
+    // Edge: zero outside the signal, same summation order as the interior
+    for (int m = 0; m < numTaps; ++m)
+    {
+        const int64_t index = first + m;
+        padded[m] = index >= 0 && index < numInput ? input[index] : 0.0f;
+    }
+    return SimdMath::dotProduct(table->getPhase(phase), padded, numTaps);
+}
+
+void Resampler::processBlock(const float* input, int numInput, float* output, int numOutput) const
+{
+    const auto& t = *table;
+
+    if (t.isBypass())
+    {
+        const int n = std::min(numInput, numOutput);
+        std::copy(input, input + n, output);
+        std::fill(output + n, output + numOutput, 0.0f);
+        return;
+    }
+
+    // Edge scratch sized from the filter, so any tap count fits
+    std::vector<float> padded(static_cast<size_t>(t.numTaps));
+
+    int64_t inputIndex = 0;
+    int phase = 0;
+
+    for (int n = 0; n < numOutput; ++n)
+    {
+        output[n] = computeSample(input, numInput, inputIndex, phase, padded.data());
+
+        phase += t.down;
+        inputIndex += phase / t.up;
+        phase %= t.up;
+    }
+}
+
+std::vector<float> Resampler::processBlock(const float* input, int numInput) const
+{
+    std::vector<float> output(static_cast<size_t>(getOutputLength(numInput)));
+    processBlock(input, numInput, output.data(), static_cast<int>(output.size()));
+    return output;
+}
+
+void Resampler::reset()
+{
+    // Zeros stand in for the samples before the start of the stream
+    streamLength = std::max(0, table->halfTaps - 1);
+    std::fill(streamBuffer.begin(), streamBuffer.begin() + streamLength, 0.0f);
+    streamPhase = 0;
+}
+
+std::pair<int, int> Resampler::process(const float* input, int numInputAvailable, float* output, int numOutput)
+{
+    const auto& t = *table;
+
+    if (t.isBypass())
+    {
+        const int n = std::min(numInputAvailable, numOutput);
+        std::copy(input, input + n, output);
+        return { n, n };
+    }
+
+    const int capacity = static_cast<int>(streamBuffer.size());
+    float* buffer = streamBuffer.data();
+    int read = 0;
+    int consumed = 0;
+    int produced = 0;
+
+    while (produced < numOutput)
+    {
+        if (read + t.numTaps > streamLength)
+        {
+            // Drop samples no later output reads
+            if (read > 0)
+            {
+                std::copy(buffer + read, buffer + streamLength, buffer);
+                streamLength -= read;
+                read = 0;
+            }
+
+            // Take only the input the remaining outputs need
+            const int64_t lastNeeded = (static_cast<int64_t>(streamPhase)
+                                        + static_cast<int64_t>(numOutput - produced - 1) * t.down) / t.up
+                                       + t.numTaps;
+            const int64_t wanted = lastNeeded - streamLength;
+            const int take = static_cast<int>(std::min<int64_t>({ wanted,
+                                                                  numInputAvailable - consumed,
+                                                                  capacity - streamLength }));
+            if (take <= 0)
+                break;
+
+            std::copy(input + consumed, input + consumed + take, buffer + streamLength);
+            streamLength += take;
+            consumed += take;
+            continue;
+        }
+
+        output[produced++] = SimdMath::dotProduct(t.getPhase(streamPhase), buffer + read, t.numTaps);
+
+        streamPhase += t.down;
+        read += streamPhase / t.up;
+        streamPhase %= t.up;
+    }
+
+    // Keep the unread history at the front for the next call
+    if (read > 0)
+    {
+        std::copy(buffer + read, buffer + streamLength, buffer);
+        streamLength -= read;
+    }
+
+    return { consumed, produced };
+}
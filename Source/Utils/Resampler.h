@@ -0,0 +1,78 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * Polyphase windowed-sinc sample rate converter.
+ *
+ * The conversion ratio is reduced to L / M (up by L, down by M); output
+ * sample n sits at input time n * M / L and is a dot product of one of the L
+ * precomputed filter phases with the surrounding input. The low-pass cutoff
+ * follows the lower of the two rates, so downsampling (e.g. to 16 kHz for
+ * FCPE) does not alias.
+ *
+ * Filter tables are cached process-wide per ratio, so the common pairs
+ * (44.1k / 48k / 16k) are built once and shared by every Resampler.
+ *
+ * Two ways to use it:
+ *  - processBlock() converts a whole buffer (stateless, thread-safe).
+ *  - process() streams arbitrary block sizes with the same output as
+ *    processBlock() on the concatenated input.
+ */
+class Resampler
+{
+public:
+    /** Bumped whenever the filter design changes; analysis cache keys include it. */
+    static constexpr int designVersion = 1;
+
+    Resampler(int sourceRate, int targetRate);
+
+    int getSourceRate() const { return sourceRate; }
+    int getTargetRate() const { return targetRate; }
+
+    /** Output samples produced from numInput input samples: floor(numInput * target / source). */
+    int getOutputLength(int numInput) const;
+
+    /**
+     * Convert a whole buffer; samples outside [0, numInput) are taken as zero.
+     * output must hold numOutput samples (usually getOutputLength(numInput)).
+     */
+    void processBlock(const float* input, int numInput, float* output, int numOutput) const;
+
+    /** Convenience: processBlock() into a new vector of getOutputLength(numInput) samples. */
+    std::vector<float> processBlock(const float* input, int numInput) const;
+
+    /** Restart the stream at input sample 0 (history is cleared). */
+    void reset();
+
+    /**
+     * Streaming conversion. Produces up to numOutput samples, reading only as
+     * much of input as they need; samples read are buffered internally, so the
+     * next call continues right after them. Does not allocate.
+     * @return {input samples consumed, output samples produced}
+     */
+    std::pair<int, int> process(const float* input, int numInputAvailable, float* output, int numOutput);
+
+    /** Input samples an output sample looks ahead of its own position. */
+    int getLookahead() const;
+
+private:
+    struct Table;
+    static std::shared_ptr<const Table> getTable(int upFactor, int downFactor);
+
+    /** padded must hold table->numTaps samples; used only near the signal edges. */
+    float computeSample(const float* input, int numInput, int64_t inputIndex, int phase, float* padded) const;
+
+    int sourceRate;
+    int targetRate;
+    std::shared_ptr<const Table> table;
+
+    // Streaming state: history starts at the first input sample the next output reads
+    std::vector<float> streamBuffer;
+    int streamLength = 0;
+    int streamPhase = 0;
+};
@@ -0,0 +1,234 @@
+#include "STFT.h"
+#include "SimdMath.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace
+{
+    /**
+     * Process-wide pool of FFT plans by backend and order. A plan is used by
+     * one thread at a time (backends keep per-plan work buffers), so
+     * workspaces borrow one and hand it back instead of sharing.
+     */
+    class FFTPlanCache
+    {
+    public:
+        static FFTPlanCache& getInstance()
+        {
+            static FFTPlanCache cache;
+            return cache;
+        }
+
+        std::unique_ptr<FFTBackend> acquire(FFTBackend::Type type, int order)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto& plans = freePlans[{ static_cast<int>(type), order }];
+                if (!plans.empty())
+                {
+                    auto plan = std::move(plans.back());
+                    plans.pop_back();
+                    return plan;
+                }
+            }
+
+            return FFTBackend::create(order, type);
+        }
+
+        void release(std::unique_ptr<FFTBackend> plan)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            freePlans[{ static_cast<int>(plan->getType()), plan->getOrder() }].push_back(std::move(plan));
+        }
+
+    private:
+        std::mutex mutex;
+        std::map<std::pair<int, int>, std::vector<std::unique_ptr<FFTBackend>>> freePlans;
+    };
+
+    std::vector<float> createWindow(STFT::WindowType type, int size)
+    {
+        std::vector<float> window(static_cast<size_t>(size));
+        const int denominator = type == STFT::WindowType::HannSymmetric ? std::max(1, size - 1) : size;
+
+        for (int i = 0; i < size; ++i)
+            window[i] = 0.5f * (1.0f - std::cos(2.0f * juce::MathConstants<float>::pi * i / denominator));
+
+        return window;
+    }
+}
+
+//==============================================================================
+STFT::Workspace::~Workspace()
+{
+    if (fft != nullptr)
+        FFTPlanCache::getInstance().release(std::move(fft));
+}
+
+STFT::Workspace& STFT::Workspace::operator=(Workspace&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (fft != nullptr)
+            FFTPlanCache::getInstance().release(std::move(fft));
+
+        fft = std::move(other.fft);
+        fftBuffer = std::move(other.fftBuffer);
+        magnitude = std::move(other.magnitude);
+    }
+    return *this;
+}
+
+//==============================================================================
+STFT::STFT(const Config& config)
+    : config(config),
+      fftOrder(static_cast<int>(std::log2(config.nFft)))
+{
+    switch (config.centering)
+    {
+        case Centering::None:        padLeft = 0; break;
+        case Centering::Center:      padLeft = config.nFft / 2; break;
+        case Centering::HalfOverlap: padLeft = (config.winSize - config.hopSize) / 2; break;
+    }
+
+    window = getWindow(config.window, config.winSize);
+}
+
+std::shared_ptr<const std::vector<float>> STFT::getWindow(WindowType type, int size)
+{
+    static std::mutex mutex;
+    static std::map<std::pair<int, int>, std::shared_ptr<const std::vector<float>>> windows;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& window = windows[{ static_cast<int>(type), size }];
+    if (window == nullptr)
+        window = std::make_shared<const std::vector<float>>(createWindow(type, size));
+    return window;
+}
+
+int STFT::getPadRight(int numSamples) const
+{
+    int padRight = 0;
+    switch (config.centering)
+    {
+        case Centering::None:        padRight = 0; break;
+        case Centering::Center:      padRight = config.nFft / 2; break;
+        case Centering::HalfOverlap: padRight = (config.winSize - config.hopSize + 1) / 2; break;
+    }
+
+    // Always leave room for at least one full window
+    return std::max(padRight, config.winSize - numSamples - padLeft);
+}
+
+int STFT::getNumFrames(int numSamples) const
+{
+    const int paddedLength = padLeft + numSamples + getPadRight(numSamples);
+    return std::max(1, 1 + (paddedLength - config.winSize) / config.hopSize);
+}
+
+bool STFT::usesReflection(int numSamples) const
+{
+    return config.padding == PaddingMode::Reflect && getPadRight(numSamples) < numSamples;
+}
+
+std::pair<int, int> STFT::getAffectedFrames(int numSamples, int startSample, int endSample) const
+{
+    const int numFrames = getNumFrames(numSamples);
+    startSample = std::max(0, startSample);
+    endSample = std::min(endSample, numSamples);
+    if (startSample >= endSample)
+        return { 0, 0 };
+
+    // Frame t reads [t * hop - padLeft, t * hop - padLeft + winSize)
+    const int firstOffset = startSample + padLeft - config.winSize;
+    int startFrame = firstOffset < 0 ? 0 : firstOffset / config.hopSize + 1;
+    int endFrame = (endSample + padLeft + config.hopSize - 1) / config.hopSize;
+
+    if (usesReflection(numSamples))
+    {
+        // Left padding mirrors samples [1, padLeft], right padding [numSamples - 1 - padRight, numSamples - 2]
+        if (padLeft > 0 && startSample <= std::min(padLeft, numSamples - 1) && endSample > 1)
+            startFrame = 0;
+        if (endSample > std::max(0, numSamples - 1 - getPadRight(numSamples)))
+            endFrame = numFrames;
+    }
+
+    return { std::min(startFrame, numFrames), std::min(endFrame, numFrames) };
+}
+
+void STFT::prepareWorkspace(Workspace& workspace) const
+{
+    // Also re-borrows when the default backend was switched since the last use
+    const auto backend = FFTBackend::getDefaultType();
+    if (workspace.fft == nullptr || workspace.fft->getOrder() != fftOrder || workspace.fft->getType() != backend)
+    {
+        workspace = Workspace();
+        workspace.fft = FFTPlanCache::getInstance().acquire(backend, fftOrder);
+    }
+
+    workspace.fftBuffer.assign(static_cast<size_t>(config.nFft) * 2, 0.0f);
+    workspace.magnitude.assign(static_cast<size_t>(getNumBins()), 0.0f);
+}
+
+void STFT::fillFrame(const float* audio, int numSamples, int frame, float* dest) const
+{
+    const int winSize = config.winSize;
+    const float* w = window->data();
+    const int first = getFrameStart(frame);
+
+    std::fill(dest, dest + static_cast<size_t>(config.nFft) * 2, 0.0f);
+
+    // Interior frames read the signal directly
+    if (first >= 0 && first + winSize <= numSamples)
+    {
+        juce::FloatVectorOperations::multiply(dest, audio + first, w, winSize);
+        return;
+    }
+
+    const bool reflect = usesReflection(numSamples);
+    const int padRight = getPadRight(numSamples);
+
+    for (int i = 0; i < winSize; ++i)
+    {
+        const int index = first + i;
+        float sample = 0.0f;
+
+        if (index >= 0 && index < numSamples)
+            sample = audio[index];
+        else if (reflect && index < 0)
+            sample = audio[std::min(-index, numSamples - 1)];
+        else if (reflect && index < numSamples + padRight)
+            sample = audio[std::max(0, 2 * numSamples - 2 - index)];
+
+        dest[i] = sample * w[i];
+    }
+}
+
+const float* STFT::computeSpectrum(const float* audio, int numSamples, int frame, Workspace& workspace) const
+{
+    float* buffer = workspace.fftBuffer.data();
+    fillFrame(audio, numSamples, frame, buffer);
+    workspace.fft->performRealOnlyForwardTransform(buffer);
+    return buffer;
+}
+
+void STFT::computeMagnitudes(const float* audio, int numSamples, int startFrame, int count,
+                             float* magnitudeT, float epsilon, Workspace& workspace) const
+{
+    const int numBins = getNumBins();
+    float* mag = workspace.magnitude.data();
+
+    for (int f = 0; f < count; ++f)
+    {
+        const float* spectrum = computeSpectrum(audio, numSamples, startFrame + f, workspace);
+
+        // Store as column f of the bin-major block
+        SimdMath::magnitude(spectrum, mag, numBins, epsilon);
+        float* column = magnitudeT + f;
+        for (int k = 0; k < numBins; ++k)
+            column[static_cast<size_t>(k) * count] = mag[k];
+    }
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "FFTBackend.h"
+#include <vector>
+#include <memory>
+#include <utility>
+
+/**
+ * Short-time Fourier transform front-end shared by all spectral analysis.
+ *
+ * Configured by sample rate, FFT size, window length and type, hop size,
+ * padding mode and centering. Framing is virtual: edge frames read the
+ * padded signal on the fly, so the input is never copied.
+ *
+ * FFT plans (of the default FFTBackend) and analysis windows come from
+ * process-wide caches, so creating an STFT (or a Workspace) after the first
+ * use of a size costs no setup.
+ */
+class STFT
+{
+public:
+    enum class WindowType
+    {
+        HannPeriodic,   // librosa / scipy default
+        HannSymmetric   // numpy.hanning
+    };
+
+    enum class PaddingMode
+    {
+        Zero,
+        Reflect         // Falls back to zero when the signal is too short to reflect
+    };
+
+    enum class Centering
+    {
+        None,           // Frame t starts at sample t * hopSize
+        Center,         // nFft / 2 samples of padding on each side (librosa center=True)
+        HalfOverlap     // (winSize - hopSize) / 2 on each side (FCPE / torch style)
+    };
+
+    struct Config
+    {
+        int sampleRate = 44100;
+        int nFft = 2048;
+        int winSize = 2048;     // Window occupies the first winSize samples of each FFT frame
+        int hopSize = 512;
+        WindowType window = WindowType::HannPeriodic;
+        PaddingMode padding = PaddingMode::Zero;
+        Centering centering = Centering::None;
+    };
+
+    /**
+     * Per-thread FFT plan and buffers. Plans are borrowed from the shared
+     * cache and returned when the workspace is destroyed.
+     */
+    class Workspace
+    {
+    public:
+        Workspace() = default;
+        ~Workspace();
+        Workspace(Workspace&&) noexcept = default;
+        Workspace& operator=(Workspace&&) noexcept;
+
+        bool isPrepared() const { return fft != nullptr; }
+
+    private:
+        friend class STFT;
+
+        std::unique_ptr<FFTBackend> fft;
+        std::vector<float> fftBuffer;   // Interleaved complex [nFft * 2]
+        std::vector<float> magnitude;   // One frame [nFft / 2 + 1]
+    };
+
+    explicit STFT(const Config& config);
+
+    const Config& getConfig() const { return config; }
+    int getNumBins() const { return config.nFft / 2 + 1; }
+
+    /** Number of frames produced for a signal of numSamples (at least 1). */
+    int getNumFrames(int numSamples) const;
+
+    /** Padding applied before the first / after the last sample. */
+    int getPadLeft() const { return padLeft; }
+    int getPadRight(int numSamples) const;
+
+    /**
+     * First sample (in the unpadded signal, may be negative) of frame t's window.
+     */
+    int getFrameStart(int frame) const { return frame * config.hopSize - padLeft; }
+
+    /**
+     * Frames {start, end} whose output depends on any of the samples
+     * [startSample, endSample), including through reflected padding.
+     */
+    std::pair<int, int> getAffectedFrames(int numSamples, int startSample, int endSample) const;
+
+    /** Allocate buffers and borrow an FFT plan for this configuration. */
+    void prepareWorkspace(Workspace& workspace) const;
+
+    /**
+     * Interleaved complex spectrum (JUCE real-only layout, nFft / 2 + 1 bins)
+     * of one frame, left in the workspace and returned.
+     */
+    const float* computeSpectrum(const float* audio, int numSamples, int frame, Workspace& workspace) const;
+
+    /**
+     * Magnitude spectra sqrt(re^2 + im^2 + epsilon) of frames
+     * [startFrame, startFrame + count), written bin-major: magnitudeT[k * count + f].
+     */
+    void computeMagnitudes(const float* audio, int numSamples, int startFrame, int count,
+                           float* magnitudeT, float epsilon, Workspace& workspace) const;
+
+    /** Shared, immutable window of the given type and length. */
+    static std::shared_ptr<const std::vector<float>> getWindow(WindowType type, int size);
+
+private:
+    bool usesReflection(int numSamples) const;
+    void fillFrame(const float* audio, int numSamples, int frame, float* dest) const;
+
+    Config config;
+    int fftOrder = 0;
+    int padLeft = 0;
+    std::shared_ptr<const std::vector<float>> window;
+};
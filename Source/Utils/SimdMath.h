@@ -0,0 +1,468 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define PITCH_EDITOR_SIMD_SSE 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+ #include <arm_neon.h>
+ #define PITCH_EDITOR_SIMD_NEON 1
+#endif
+
+/**
+ * Small SIMD kernels for the analysis hot loops (SSE2 / AArch64 NEON with a
+ * scalar fallback that produces the same results).
+ *
+ * Accuracy versus the plain scalar code:
+ *  - magnitude() and multiplyAccumulateColumns() use the same operation order
+ *    as the scalar loops and are bit-identical.
+ *  - dotProduct() sums in four interleaved lanes on every path, so it is
+ *    bit-identical across paths (but not to a plain sequential sum).
+ *  - argMax() returns the same index as a sequential scan.
+ *  - maxPlusBanded() only adds and takes maxima, so it is bit-identical.
+ *  - logClamped() uses a Cephes-style polynomial log; for the clamped inputs
+ *    seen here (>= 1e-5) it is within 2e-6 absolute of std::log.
+ */
+namespace SimdMath
+{
+    /** Width of the SIMD float vectors used below. */
+#if PITCH_EDITOR_SIMD_SSE || PITCH_EDITOR_SIMD_NEON
+    constexpr int vectorSize = 4;
+#else
+    constexpr int vectorSize = 1;
+#endif
+
+    namespace detail
+    {
+        constexpr float logSqrtHalf = 0.707106781186547524f;
+        constexpr float logP0 = 7.0376836292e-2f;
+        constexpr float logP1 = -1.1514610310e-1f;
+        constexpr float logP2 = 1.1676998740e-1f;
+        constexpr float logP3 = -1.2420140846e-1f;
+        constexpr float logP4 = 1.4249322787e-1f;
+        constexpr float logP5 = -1.6668057665e-1f;
+        constexpr float logP6 = 2.0000714765e-1f;
+        constexpr float logP7 = -2.4999993993e-1f;
+        constexpr float logP8 = 3.3333331174e-1f;
+        constexpr float logQ1 = -2.12194440e-4f;
+        constexpr float logQ2 = 0.693359375f;
+
+        /** Scalar version of the vector log below (positive, normal x only). */
+        inline float logPositive(float x)
+        {
+            std::uint32_t bits;
+            std::memcpy(&bits, &x, sizeof(bits));
+
+            float e = static_cast<float>(static_cast<int>(bits >> 23) - 0x7f) + 1.0f;
+
+            // Mantissa in [0.5, 1)
+            bits = (bits & 0x007fffffu) | 0x3f000000u;
+            std::memcpy(&x, &bits, sizeof(x));
+
+            // Same operation order as the vector path: (x - 1) + (x < sqrt(0.5) ? x : 0)
+            const float tmp = x < logSqrtHalf ? x : 0.0f;
+            e -= x < logSqrtHalf ? 1.0f : 0.0f;
+            x = (x - 1.0f) + tmp;
+
+            const float z = x * x;
+
+            float y = logP0;
+            y = y * x + logP1;
+            y = y * x + logP2;
+            y = y * x + logP3;
+            y = y * x + logP4;
+            y = y * x + logP5;
+            y = y * x + logP6;
+            y = y * x + logP7;
+            y = y * x + logP8;
+            y = y * x;
+            y = y * z;
+
+            y = y + e * logQ1;
+            y = y + (-0.5f * z);
+            x = x + y;
+            x = x + e * logQ2;
+            return x;
+        }
+    }
+
+    /**
+     * Magnitude of an interleaved complex spectrum (JUCE real-only FFT layout):
+     * out[k] = sqrt(re[k]^2 + im[k]^2 + epsilon).
+     */
+    inline void magnitude(const float* interleaved, float* out, int numBins, float epsilon)
+    {
+        int k = 0;
+
+#if PITCH_EDITOR_SIMD_SSE
+        const __m128 eps = _mm_set1_ps(epsilon);
+        for (; k + 4 <= numBins; k += 4)
+        {
+            const __m128 a = _mm_loadu_ps(interleaved + k * 2);
+            const __m128 b = _mm_loadu_ps(interleaved + k * 2 + 4);
+            const __m128 re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            const __m128 im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            const __m128 power = _mm_add_ps(_mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im)), eps);
+            _mm_storeu_ps(out + k, _mm_sqrt_ps(power));
+        }
+#elif PITCH_EDITOR_SIMD_NEON
+        const float32x4_t eps = vdupq_n_f32(epsilon);
+        for (; k + 4 <= numBins; k += 4)
+        {
+            const float32x4x2_t c = vld2q_f32(interleaved + k * 2);
+            const float32x4_t power = vaddq_f32(vaddq_f32(vmulq_f32(c.val[0], c.val[0]),
+                                                          vmulq_f32(c.val[1], c.val[1])), eps);
+            vst1q_f32(out + k, vsqrtq_f32(power));
+        }
+#endif
+
+        for (; k < numBins; ++k)
+        {
+            const float re = interleaved[k * 2];
+            const float im = interleaved[k * 2 + 1];
+            out[k] = std::sqrt(re * re + im * im + epsilon);
+        }
+    }
+
+    /**
+     * Small GEMM micro-kernel over columns:
+     * out[f] = sum_k weights[k] * rows[k * rowStride + f] for f in [0, numColumns).
+     * Each column is summed in k order starting from zero, like a scalar dot product.
+     */
+    inline void multiplyAccumulateColumns(const float* rows, int rowStride,
+                                          const float* weights, int numWeights,
+                                          float* out, int numColumns)
+    {
+        int f = 0;
+
+#if PITCH_EDITOR_SIMD_SSE
+        for (; f + 8 <= numColumns; f += 8)
+        {
+            __m128 acc0 = _mm_setzero_ps();
+            __m128 acc1 = _mm_setzero_ps();
+            const float* src = rows + f;
+            for (int k = 0; k < numWeights; ++k, src += rowStride)
+            {
+                const __m128 w = _mm_set1_ps(weights[k]);
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(src), w));
+                acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(src + 4), w));
+            }
+            _mm_storeu_ps(out + f, acc0);
+            _mm_storeu_ps(out + f + 4, acc1);
+        }
+        for (; f + 4 <= numColumns; f += 4)
+        {
+            __m128 acc = _mm_setzero_ps();
+            const float* src = rows + f;
+            for (int k = 0; k < numWeights; ++k, src += rowStride)
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(src), _mm_set1_ps(weights[k])));
+            _mm_storeu_ps(out + f, acc);
+        }
+#elif PITCH_EDITOR_SIMD_NEON
+        for (; f + 8 <= numColumns; f += 8)
+        {
+            float32x4_t acc0 = vdupq_n_f32(0.0f);
+            float32x4_t acc1 = vdupq_n_f32(0.0f);
+            const float* src = rows + f;
+            for (int k = 0; k < numWeights; ++k, src += rowStride)
+            {
+                const float32x4_t w = vdupq_n_f32(weights[k]);
+                acc0 = vaddq_f32(acc0, vmulq_f32(vld1q_f32(src), w));
+                acc1 = vaddq_f32(acc1, vmulq_f32(vld1q_f32(src + 4), w));
+            }
+            vst1q_f32(out + f, acc0);
+            vst1q_f32(out + f + 4, acc1);
+        }
+        for (; f + 4 <= numColumns; f += 4)
+        {
+            float32x4_t acc = vdupq_n_f32(0.0f);
+            const float* src = rows + f;
+            for (int k = 0; k < numWeights; ++k, src += rowStride)
+                acc = vaddq_f32(acc, vmulq_f32(vld1q_f32(src), vdupq_n_f32(weights[k])));
+            vst1q_f32(out + f, acc);
+        }
+#endif
+
+        for (; f < numColumns; ++f)
+        {
+            float sum = 0.0f;
+            const float* src = rows + f;
+            for (int k = 0; k < numWeights; ++k, src += rowStride)
+                sum += *src * weights[k];
+            out[f] = sum;
+        }
+    }
+
+    /**
+     * sum_i a[i] * b[i], accumulated in four lanes (i mod 4) that are combined
+     * as (lane0 + lane1) + (lane2 + lane3), then the tail is added in order.
+     */
+    inline float dotProduct(const float* a, const float* b, int count)
+    {
+        int i = 0;
+        float lanes[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+#if PITCH_EDITOR_SIMD_SSE
+        __m128 acc = _mm_setzero_ps();
+        for (; i + 4 <= count; i += 4)
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        _mm_storeu_ps(lanes, acc);
+#elif PITCH_EDITOR_SIMD_NEON
+        float32x4_t acc = vdupq_n_f32(0.0f);
+        for (; i + 4 <= count; i += 4)
+            acc = vaddq_f32(acc, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+        vst1q_f32(lanes, acc);
+#else
+        for (; i + 4 <= count; i += 4)
+            for (int lane = 0; lane < 4; ++lane)
+                lanes[lane] += a[i + lane] * b[i + lane];
+#endif
+
+        float sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        for (; i < count; ++i)
+            sum += a[i] * b[i];
+        return sum;
+    }
+
+    /**
+     * Index of the largest of data[0, count) (the first one on ties, as a
+     * sequential scan with '>' would pick); its value goes to maxValue.
+     * count must be at least 1.
+     */
+    inline int argMax(const float* data, int count, float& maxValue)
+    {
+        int i = 0;
+        int best = 0;
+        float bestValue = data[0];
+
+#if PITCH_EDITOR_SIMD_SSE || PITCH_EDITOR_SIMD_NEON
+        if (count >= 8)
+        {
+            // Each lane tracks the first maximum among the elements it sees
+            float laneValues[4];
+            std::int32_t laneIndices[4];
+
+ #if PITCH_EDITOR_SIMD_SSE
+            __m128 values = _mm_loadu_ps(data);
+            __m128i indices = _mm_setr_epi32(0, 1, 2, 3);
+            __m128i current = indices;
+            const __m128i step = _mm_set1_epi32(4);
+
+            for (i = 4; i + 4 <= count; i += 4)
+            {
+                current = _mm_add_epi32(current, step);
+                const __m128 x = _mm_loadu_ps(data + i);
+                const __m128 greater = _mm_cmpgt_ps(x, values);
+                const __m128i greaterBits = _mm_castps_si128(greater);
+
+                values = _mm_or_ps(_mm_and_ps(greater, x), _mm_andnot_ps(greater, values));
+                indices = _mm_or_si128(_mm_and_si128(greaterBits, current), _mm_andnot_si128(greaterBits, indices));
+            }
+
+            _mm_storeu_ps(laneValues, values);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(laneIndices), indices);
+ #else
+            float32x4_t values = vld1q_f32(data);
+            const std::int32_t initialIndices[4] = { 0, 1, 2, 3 };
+            int32x4_t indices = vld1q_s32(initialIndices);
+            int32x4_t current = indices;
+            const int32x4_t step = vdupq_n_s32(4);
+
+            for (i = 4; i + 4 <= count; i += 4)
+            {
+                current = vaddq_s32(current, step);
+                const float32x4_t x = vld1q_f32(data + i);
+                const uint32x4_t greater = vcgtq_f32(x, values);
+
+                values = vbslq_f32(greater, x, values);
+                indices = vbslq_s32(greater, current, indices);
+            }
+
+            vst1q_f32(laneValues, values);
+            vst1q_s32(laneIndices, indices);
+ #endif
+
+            // Across lanes: largest value, lowest index among equal values
+            bestValue = laneValues[0];
+            best = laneIndices[0];
+            for (int lane = 1; lane < 4; ++lane)
+            {
+                if (laneValues[lane] > bestValue
+                    || (laneValues[lane] == bestValue && laneIndices[lane] < best))
+                {
+                    bestValue = laneValues[lane];
+                    best = laneIndices[lane];
+                }
+            }
+        }
+#endif
+
+        for (i = std::max(i, 1); i < count; ++i)
+        {
+            if (data[i] > bestValue)
+            {
+                bestValue = data[i];
+                best = i;
+            }
+        }
+
+        maxValue = bestValue;
+        return best;
+    }
+
+    /**
+     * Banded max-plus step (the inner loop of a Viterbi pass):
+     *   out[j] = max over |d| <= band of prev[j + d] + weights[|d|]
+     * for j in [0, count). prev must be readable over [-band, count + band)
+     * (pad with a very negative value). Only maxima are kept, so the result
+     * does not depend on the evaluation order; callers that need the
+     * winning d recompute it for the few entries they follow.
+     */
+    inline void maxPlusBanded(const float* prev, const float* weights, int band, int count, float* out)
+    {
+        int j = 0;
+
+#if PITCH_EDITOR_SIMD_SSE
+        for (; j + 4 <= count; j += 4)
+        {
+            __m128 best = _mm_add_ps(_mm_loadu_ps(prev + j), _mm_set1_ps(weights[0]));
+
+            for (int d = 1; d <= band; ++d)
+            {
+                // max(a + w, b + w) == max(a, b) + w exactly, so the pair shares one add
+                const __m128 pair = _mm_max_ps(_mm_loadu_ps(prev + j - d), _mm_loadu_ps(prev + j + d));
+                best = _mm_max_ps(best, _mm_add_ps(pair, _mm_set1_ps(weights[d])));
+            }
+
+            _mm_storeu_ps(out + j, best);
+        }
+#elif PITCH_EDITOR_SIMD_NEON
+        for (; j + 4 <= count; j += 4)
+        {
+            float32x4_t best = vaddq_f32(vld1q_f32(prev + j), vdupq_n_f32(weights[0]));
+
+            for (int d = 1; d <= band; ++d)
+            {
+                const float32x4_t pair = vmaxq_f32(vld1q_f32(prev + j - d), vld1q_f32(prev + j + d));
+                best = vmaxq_f32(best, vaddq_f32(pair, vdupq_n_f32(weights[d])));
+            }
+
+            vst1q_f32(out + j, best);
+        }
+#endif
+
+        for (; j < count; ++j)
+        {
+            const float* centre = prev + j;
+            float best = centre[0] + weights[0];
+
+            for (int d = 1; d <= band; ++d)
+                best = std::max(best, std::max(*(centre - d), centre[d]) + weights[d]);
+
+            out[j] = best;
+        }
+    }
+
+    /**
+     * In-place data[i] = log(max(data[i], floor)).
+     * floor must be a positive normal number.
+     */
+    inline void logClamped(float* data, int count, float floor)
+    {
+        using namespace detail;
+        int i = 0;
+
+#if PITCH_EDITOR_SIMD_SSE
+        const __m128 vFloor = _mm_set1_ps(floor);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 mantissaMask = _mm_castsi128_ps(_mm_set1_epi32(0x007fffff));
+        const __m128 sqrtHalf = _mm_set1_ps(logSqrtHalf);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 x = _mm_max_ps(_mm_loadu_ps(data + i), vFloor);
+
+            const __m128i exponentBits = _mm_srli_epi32(_mm_castps_si128(x), 23);
+            __m128 e = _mm_add_ps(_mm_cvtepi32_ps(_mm_sub_epi32(exponentBits, _mm_set1_epi32(0x7f))), one);
+
+            x = _mm_or_ps(_mm_and_ps(x, mantissaMask), half);
+
+            const __m128 belowSqrtHalf = _mm_cmplt_ps(x, sqrtHalf);
+            const __m128 tmp = _mm_and_ps(x, belowSqrtHalf);
+            x = _mm_sub_ps(x, one);
+            e = _mm_sub_ps(e, _mm_and_ps(one, belowSqrtHalf));
+            x = _mm_add_ps(x, tmp);
+
+            const __m128 z = _mm_mul_ps(x, x);
+
+            __m128 y = _mm_set1_ps(logP0);
+            y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(logP1));
+            y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(logP2));
+            y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(logP3));
+            y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(logP4));
+            y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(logP5));
+            y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(logP6));
+            y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(logP7));
+            y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(logP8));
+            y = _mm_mul_ps(y, x);
+            y = _mm_mul_ps(y, z);
+
+            y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(logQ1)));
+            y = _mm_add_ps(y, _mm_mul_ps(z, _mm_set1_ps(-0.5f)));
+            x = _mm_add_ps(x, y);
+            x = _mm_add_ps(x, _mm_mul_ps(e, _mm_set1_ps(logQ2)));
+
+            _mm_storeu_ps(data + i, x);
+        }
+#elif PITCH_EDITOR_SIMD_NEON
+        const float32x4_t vFloor = vdupq_n_f32(floor);
+        const float32x4_t one = vdupq_n_f32(1.0f);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            float32x4_t x = vmaxq_f32(vld1q_f32(data + i), vFloor);
+
+            const int32x4_t exponentBits = vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_f32(x), 23));
+            float32x4_t e = vaddq_f32(vcvtq_f32_s32(vsubq_s32(exponentBits, vdupq_n_s32(0x7f))), one);
+
+            x = vreinterpretq_f32_u32(vorrq_u32(vandq_u32(vreinterpretq_u32_f32(x), vdupq_n_u32(0x007fffffu)),
+                                                vdupq_n_u32(0x3f000000u)));
+
+            const uint32x4_t belowSqrtHalf = vcltq_f32(x, vdupq_n_f32(logSqrtHalf));
+            const float32x4_t tmp = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(x), belowSqrtHalf));
+            x = vsubq_f32(x, one);
+            e = vsubq_f32(e, vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(one), belowSqrtHalf)));
+            x = vaddq_f32(x, tmp);
+
+            const float32x4_t z = vmulq_f32(x, x);
+
+            float32x4_t y = vdupq_n_f32(logP0);
+            y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(logP1));
+            y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(logP2));
+            y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(logP3));
+            y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(logP4));
+            y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(logP5));
+            y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(logP6));
+            y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(logP7));
+            y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(logP8));
+            y = vmulq_f32(y, x);
+            y = vmulq_f32(y, z);
+
+            y = vaddq_f32(y, vmulq_f32(e, vdupq_n_f32(logQ1)));
+            y = vaddq_f32(y, vmulq_f32(z, vdupq_n_f32(-0.5f)));
+            x = vaddq_f32(x, y);
+            x = vaddq_f32(x, vmulq_f32(e, vdupq_n_f32(logQ2)));
+
+            vst1q_f32(data + i, x);
+        }
+#endif
+
+        for (; i < count; ++i)
+            data[i] = logPositive(data[i] > floor ? data[i] : floor);
+    }
+}
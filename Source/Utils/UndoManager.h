@@ -89,6 +89,47 @@ private:
     std::vector<F0FrameEdit> edits;
 };
 
+/**
+ * Action for re-detecting a frame range: the F0 curve edit plus the
+ * per-note F0 values rebuilt from it.
+ */
+struct NoteF0Edit
+{
+    Note* note = nullptr;
+    std::vector<float> oldF0;
+    std::vector<float> newF0;
+};
+
+class F0RedetectAction : public UndoableAction
+{
+public:
+    F0RedetectAction(std::vector<float>* f0Array,
+                     std::vector<bool>* voicedMask,
+                     std::vector<F0FrameEdit> edits,
+                     std::vector<NoteF0Edit> noteEdits)
+        : curveEdit(f0Array, voicedMask, std::move(edits)), noteEdits(std::move(noteEdits)) {}
+    
+    void undo() override
+    {
+        curveEdit.undo();
+        for (const auto& e : noteEdits)
+            if (e.note) e.note->setF0Values(e.oldF0);
+    }
+    
+    void redo() override
+    {
+        curveEdit.redo();
+        for (const auto& e : noteEdits)
+            if (e.note) e.note->setF0Values(e.newF0);
+    }
+    
+    juce::String getName() const override { return "Re-detect Pitch"; }
+    
+private:
+    F0EditAction curveEdit;
+    std::vector<NoteF0Edit> noteEdits;
+};
+
 /**
  * Simple undo manager for the pitch editor.
  */
@@ -0,0 +1,97 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool& WorkerPool::getInstance()
+{
+    static WorkerPool pool(std::max(0, static_cast<int>(std::thread::hardware_concurrency()) - 1));
+    return pool;
+}
+
+WorkerPool::WorkerPool(int numHelperThreads)
+{
+    threads.reserve(static_cast<size_t>(std::max(0, numHelperThreads)));
+    for (int i = 0; i < numHelperThreads; ++i)
+        threads.emplace_back([this, i]() { workerLoop(i + 1); });  // Index 0 is the caller
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+
+    for (auto& t : threads)
+        if (t.joinable())
+            t.join();
+}
+
+void WorkerPool::parallelFor(int numTasks, const std::function<void(int, int)>& fn)
+{
+    if (numTasks <= 0)
+        return;
+
+    if (threads.empty() || numTasks == 1)
+    {
+        for (int i = 0; i < numTasks; ++i)
+            fn(i, 0);
+        return;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->fn = &fn;
+    job->numTasks = numTasks;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    jobs.push_back(job);
+    workAvailable.notify_all();
+
+    // The caller works too, so progress never depends on a free pool thread
+    while (runOneTask(job, 0, lock))
+    {
+    }
+
+    job->finished.wait(lock, [&job]() { return job->completedTasks == job->numTasks; });
+}
+
+bool WorkerPool::runOneTask(const std::shared_ptr<Job>& job, int workerIndex, std::unique_lock<std::mutex>& lock)
+{
+    if (job->nextTask >= job->numTasks)
+        return false;
+
+    const int taskIndex = job->nextTask++;
+
+    // Last task handed out: nobody else needs to find this job
+    if (job->nextTask == job->numTasks)
+    {
+        auto it = std::find(jobs.begin(), jobs.end(), job);
+        if (it != jobs.end())
+            jobs.erase(it);
+    }
+
+    lock.unlock();
+    (*job->fn)(taskIndex, workerIndex);
+    lock.lock();
+
+    if (++job->completedTasks == job->numTasks)
+        job->finished.notify_all();
+
+    return true;
+}
+
+void WorkerPool::workerLoop(int workerIndex)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;)
+    {
+        workAvailable.wait(lock, [this]() { return stopping || !jobs.empty(); });
+
+        if (jobs.empty())
+            return;  // Stopping and nothing left to do
+
+        auto job = jobs.front();
+        runOneTask(job, workerIndex, lock);
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * Process-wide pool of worker threads for data-parallel analysis loops.
+ *
+ * parallelFor() hands out task indices to the pool threads and to the calling
+ * thread, which always participates. Calls may be nested or issued from
+ * several threads at once without deadlocking: if every pool thread is busy
+ * the caller simply runs the remaining tasks itself.
+ */
+class WorkerPool
+{
+public:
+    /** Shared pool sized to the machine (hardware threads - 1 helpers). */
+    static WorkerPool& getInstance();
+
+    explicit WorkerPool(int numHelperThreads);
+    ~WorkerPool();
+
+    /**
+     * Upper bound (exclusive) of the workerIndex values parallelFor passes,
+     * i.e. the number of per-worker scratch slots a caller needs.
+     */
+    int getMaxConcurrency() const { return static_cast<int>(threads.size()) + 1; }
+
+    /**
+     * Run fn(taskIndex, workerIndex) for each taskIndex in [0, numTasks) and
+     * wait for all of them. workerIndex is unique among the tasks of this call
+     * that run concurrently, so it can select per-worker scratch buffers.
+     * fn must not throw.
+     */
+    void parallelFor(int numTasks, const std::function<void(int, int)>& fn);
+
+private:
+    struct Job
+    {
+        const std::function<void(int, int)>* fn = nullptr;
+        int numTasks = 0;
+        int nextTask = 0;       // Guarded by pool mutex
+        int completedTasks = 0; // Guarded by pool mutex
+        std::condition_variable finished;
+    };
+
+    void workerLoop(int workerIndex);
+    bool runOneTask(const std::shared_ptr<Job>& job, int workerIndex, std::unique_lock<std::mutex>& lock);
+
+    std::vector<std::thread> threads;
+    std::deque<std::shared_ptr<Job>> jobs;
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    bool stopping = false;
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+};